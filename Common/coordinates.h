@@ -3,47 +3,158 @@
 
 #include <SFML/System/Vector2.hpp>
 #include <array>
+#include <cmath>
 #include <iostream>
 #include <limits>
 #include <math.h>
+#include <span>
+#include <vector>
 
-struct Point2D{
-  double x{};
-  double y{};
-  Point2D() = default;
-  Point2D( double _x, double _y ) : x(_x), y(_y) {}
-  template<typename T>
-  Point2D( const sf::Vector2<T>& vec ) : 
-    x( static_cast<double>(vec.x) ),
-    y( static_cast<double>(vec.y) ){}
+template<typename T>
+using RotationMatrix = std::array< std::array<T, 2>, 2>;
 
-  void Print() const;
+template<typename T>
+struct Vec2{
+  T x{};
+  T y{};
+  constexpr Vec2() = default;
+  constexpr Vec2( T _x, T _y ) : x(_x), y(_y) {}
+  template<typename U>
+  constexpr Vec2( const sf::Vector2<U>& vec ) : 
+    x( static_cast<T>(vec.x) ),
+    y( static_cast<T>(vec.y) ){}
+  template<typename U>
+  constexpr explicit Vec2( const Vec2<U>& vec ) : 
+    x( static_cast<T>(vec.x) ),
+    y( static_cast<T>(vec.y) ){}
 
-  void Rotate( const Point2D& p, double theta );
+  void Print() const { std::cout << "(x=" << x << ", y=" << y << " ) " << "\n"; }
+
+  void Rotate( const Vec2& p, T theta ){
+    auto cos_theta = std::cos( theta );
+    auto sin_theta = std::sin( theta );
+    auto rel_x = x - p.x;
+    auto rel_y = y - p.y;
+    x = rel_x * cos_theta - rel_y*sin_theta + p.x;
+    y = rel_x * sin_theta + rel_y*cos_theta + p.y;
+  }
 
   auto SfVector() const{ return sf::Vector2(static_cast<float>(x), static_cast<float>(y)); }
 
-  double Mag() const;
+  T Mag() const { return std::sqrt( x*x + y*y ); }
 
-  void operator+=( const Point2D& other );
-  void operator-=( const Point2D& other );
-  void operator*=( double scale );
-  void operator*=( std::array< std::array<double, 2>, 2> matrix );
-  void operator/=( double scale );
-  bool operator==( const Point2D& other ) const;
+  constexpr Vec2& operator+=( const Vec2& other ){ x+=other.x; y+=other.y; return *this; }
+  constexpr Vec2& operator-=( const Vec2& other ){ x-=other.x; y-=other.y; return *this; }
+  constexpr Vec2& operator*=( T scale ){ x*=scale; y*=scale; return *this; }
+  constexpr Vec2& operator*=( const RotationMatrix<T>& matrix ){
+    auto new_x = x*matrix[0][0] + y*matrix[0][1];
+    auto new_y = x*matrix[1][0] + y*matrix[1][1];
+    x = new_x;
+    y = new_y;
+    return *this;
+  }
+  constexpr Vec2& operator/=( T scale ){ x/=scale; y/=scale; return *this; }
+  constexpr bool operator==( const Vec2& other ) const {
+    if( ( x > other.x ? x - other.x : other.x - x ) > std::numeric_limits<T>::min() )
+      return false;
+    if( ( y > other.y ? y - other.y : other.y - y ) > std::numeric_limits<T>::min() )
+      return false;
+    return true;
+  }
   
-  friend Point2D operator+(const Point2D& first, const Point2D& second);
-  friend Point2D operator-(const Point2D& first, const Point2D& second);
-  friend Point2D operator*(const Point2D& first, double scale);
-  friend Point2D operator*(const Point2D& first, std::array< std::array<double, 2>, 2> matrix);
-  friend Point2D operator/(const Point2D& first, double scale);
+  friend constexpr Vec2 operator+( Vec2 first, const Vec2& second ){ return first+=second; }
+  friend constexpr Vec2 operator-( Vec2 first, const Vec2& second ){ return first-=second; }
+  friend constexpr Vec2 operator*( Vec2 first, T scale ){ return first*=scale; }
+  friend constexpr Vec2 operator*( Vec2 first, const RotationMatrix<T>& matrix ){ return first*=matrix; }
+  friend constexpr Vec2 operator/( Vec2 first, T scale ){ return first/=scale; }
   
-  friend double Distance( const Point2D& first, const Point2D& second );
-  friend Point2D Direction(const Point2D& first, const Point2D& second);
-  friend double Dot( Point2D f, Point2D s );
-  friend double Angle( Point2D f, Point2D s );
+  friend T Distance( const Vec2& first, const Vec2& second ){ return ( first - second ).Mag(); }
+  friend Vec2 Direction( const Vec2& first, const Vec2& second ){ return ( second - first ) / Distance(first, second); }
+  friend constexpr T Dot( const Vec2& f, const Vec2& s ){ return f.x*s.x + f.y*s.y; }
+  friend T Angle( const Vec2& f, const Vec2& s ){
+    auto f_mag = f.Mag();
+    auto s_mag = s.Mag();
+    auto dot_product = Dot(f, s);
+    if( std::fabs(f_mag) < std::numeric_limits<T>::epsilon() )
+      return 0;
+    if( std::fabs(s_mag) < std::numeric_limits<T>::epsilon() )
+      return 0;
+    if( std::fabs(dot_product - 1) < std::numeric_limits<T>::epsilon() )
+      return 0;
+    return std::acos( dot_product / f_mag / s_mag );
+  }
 };
 
-std::array< std::array<double, 2>, 2> MakeRotationMatrix(double theta);
+using Point2D = Vec2<double>;
+
+template<typename T = double>
+RotationMatrix<T> MakeRotationMatrix( T theta ){
+  auto cos_theta = std::cos( theta );
+  auto sin_theta = std::sin( theta );
+  return RotationMatrix<T>{
+    std::array<T, 2>{cos_theta, -1*sin_theta},
+    std::array<T, 2>{sin_theta, cos_theta},
+  };
+}
+
+// Batch kernels. The loops are plain element-wise passes over contiguous memory so the compiler
+// can vectorize them; the SoA overloads take separate x and y arrays as used by the physics.
+
+template<typename T>
+constexpr void Translate( std::span<Vec2<T>> points, const Vec2<T>& offset ) noexcept {
+  for( auto& p : points )
+    p += offset;
+}
+template<typename T>
+constexpr void Translate( std::span<T> xs, std::span<T> ys, const Vec2<T>& offset ) noexcept {
+  for( size_t i=0; i<xs.size(); ++i ){
+    xs[i] += offset.x;
+    ys[i] += offset.y;
+  }
+}
+template<typename T>
+void Rotate( std::span<Vec2<T>> points, const Vec2<T>& center, T theta ) noexcept {
+  auto matrix = MakeRotationMatrix( theta );
+  for( auto& p : points )
+    p = ( p - center ) * matrix + center;
+}
+template<typename T>
+void Distance( std::span<const Vec2<T>> points, const Vec2<T>& to, std::span<T> out ) noexcept {
+  for( size_t i=0; i<points.size(); ++i )
+    out[i] = Distance( points[i], to );
+}
+template<typename T>
+void Distance( std::span<const T> xs, std::span<const T> ys, const Vec2<T>& to, std::span<T> out ) noexcept {
+  for( size_t i=0; i<xs.size(); ++i )
+    out[i] = std::sqrt( ( xs[i] - to.x )*( xs[i] - to.x ) + ( ys[i] - to.y )*( ys[i] - to.y ) );
+}
+template<typename T>
+constexpr void Dot( std::span<const Vec2<T>> first, std::span<const Vec2<T>> second, std::span<T> out ) noexcept {
+  for( size_t i=0; i<first.size(); ++i )
+    out[i] = Dot( first[i], second[i] );
+}
+
+// Mixed precision storage: positions are kept as T offsets (usually float) from a double origin.
+// Placing the origin near the points keeps the offsets small, so float keeps enough relative
+// precision while packing twice as many lanes into a SIMD register as double.
+template<typename T>
+struct OffsetPoints{
+  Point2D origin{};
+  std::vector<T> x{};
+  std::vector<T> y{};
+
+  auto Size() const noexcept -> size_t { return x.size(); }
+  auto At( size_t i ) const noexcept -> Point2D { return { origin.x + x[i], origin.y + y[i] }; }
+  auto Offset( const Point2D& p ) const noexcept -> Vec2<T> { return { static_cast<T>( p.x - origin.x ), static_cast<T>( p.y - origin.y ) }; }
+  auto Assign( std::span<const double> xs, std::span<const double> ys, const Point2D& new_origin ) -> void {
+    origin = new_origin;
+    x.resize( xs.size() );
+    y.resize( ys.size() );
+    for( size_t i=0; i<xs.size(); ++i ){
+      x[i] = static_cast<T>( xs[i] - origin.x );
+      y[i] = static_cast<T>( ys[i] - origin.y );
+    }
+  }
+};
 
 #endif // COORDINATES_H
@@ -0,0 +1,152 @@
+#include "profiler.h"
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <stdexcept>
+
+namespace Profiler{
+
+#ifdef PROFILER_ENABLED
+
+namespace {
+
+// Slots are atomics so that a reader may look at a ring while its thread keeps writing; a slot
+// overwritten during the read can yield one mixed-up event, never undefined behaviour.
+struct Slot{
+  std::atomic<const char*> name{nullptr};
+  std::atomic<int64_t> begin{};
+  std::atomic<int64_t> end{};
+};
+
+struct Ring{
+  explicit Ring( uint32_t thread ) : thread{thread} {}
+  uint32_t thread;
+  alignas(64) std::atomic<uint64_t> head{0};
+  std::atomic<uint64_t> tail{0};
+  std::array<Slot, RING_SIZE> slots{};
+};
+
+struct Event{
+  const char* name;
+  int64_t begin;
+  int64_t end;
+  uint32_t thread;
+};
+
+// Rings outlive their threads so that the events of finished threads can still be read.
+struct Registry{
+  std::mutex mutex{};
+  std::vector<std::shared_ptr<Ring>> rings{};
+};
+
+auto GetRegistry() -> Registry& {
+  static auto registry = Registry{};
+  return registry;
+}
+
+auto GetRing() -> Ring& {
+  thread_local auto ring = [](){
+    auto& registry = GetRegistry();
+    auto lock = std::lock_guard{ registry.mutex };
+    auto ring = std::make_shared<Ring>( static_cast<uint32_t>( registry.rings.size() ) );
+    registry.rings.push_back( ring );
+    return ring;
+  }();
+  return *ring;
+}
+
+auto Collect() -> std::vector<Event> {
+  auto events = std::vector<Event>{};
+  auto& registry = GetRegistry();
+  auto lock = std::lock_guard{ registry.mutex };
+  for( const auto& ring : registry.rings ){
+    auto head = ring->head.load( std::memory_order_acquire );
+    auto first = std::max( ring->tail.load( std::memory_order_relaxed ), head > RING_SIZE ? head - RING_SIZE : 0 );
+    for( auto i=first; i<head; ++i ){
+      const auto& slot = ring->slots[ i % RING_SIZE ];
+      events.push_back( { slot.name.load( std::memory_order_relaxed ), slot.begin.load( std::memory_order_relaxed ),
+                          slot.end.load( std::memory_order_relaxed ), ring->thread } );
+    }
+  }
+  return events;
+}
+
+auto Percentile( const std::vector<int64_t>& sorted, double q ) -> double {
+  auto index = static_cast<size_t>( q * static_cast<double>( sorted.size() - 1 ) + 0.5 );
+  return static_cast<double>( sorted[index] ) * 1e-6;
+}
+
+}
+
+auto Now() noexcept -> int64_t {
+  return std::chrono::duration_cast<std::chrono::nanoseconds>( std::chrono::steady_clock::now().time_since_epoch() ).count();
+}
+
+auto Record( const char* name, int64_t begin_ns, int64_t end_ns ) noexcept -> void {
+  auto& ring = GetRing();
+  auto head = ring.head.load( std::memory_order_relaxed );
+  auto& slot = ring.slots[ head % RING_SIZE ];
+  slot.name.store( name, std::memory_order_relaxed );
+  slot.begin.store( begin_ns, std::memory_order_relaxed );
+  slot.end.store( end_ns, std::memory_order_relaxed );
+  ring.head.store( head + 1, std::memory_order_release );
+}
+
+auto Summary() -> std::vector<StageStats> {
+  auto durations = std::map<std::string, std::vector<int64_t>>{};
+  for( const auto& event : Collect() )
+    if( event.name )
+      durations[event.name].push_back( event.end - event.begin );
+  auto stats = std::vector<StageStats>{};
+  for( auto& [name, stage] : durations ){
+    std::sort( stage.begin(), stage.end() );
+    stats.push_back( { name, stage.size(), Percentile( stage, 0.5 ), Percentile( stage, 0.99 ), Percentile( stage, 1.0 ) } );
+  }
+  return stats;
+}
+
+auto ExportChromeTrace( const std::string& path ) -> void {
+  auto file = std::unique_ptr<std::FILE, int(*)(std::FILE*)>{ std::fopen( path.c_str(), "w" ), &std::fclose };
+  if( !file )
+    throw std::runtime_error( "Profiler: cannot open " + path );
+  auto ok = std::fputs( "{\"traceEvents\":[", file.get() ) >= 0;
+  auto separator = "\n";
+  for( const auto& event : Collect() ){
+    if( !event.name )
+      continue;
+    ok = ok && std::fprintf( file.get(), "%s{\"name\":\"%s\",\"ph\":\"X\",\"pid\":1,\"tid\":%u,\"ts\":%.3f,\"dur\":%.3f}",
+                             separator, event.name, event.thread, event.begin * 1e-3, ( event.end - event.begin ) * 1e-3 ) > 0;
+    separator = ",\n";
+  }
+  ok = ok && std::fputs( "\n],\"displayTimeUnit\":\"ms\"}\n", file.get() ) >= 0;
+  if( !ok )
+    throw std::runtime_error( "Profiler: write to " + path + " failed" );
+}
+
+auto Clear() -> void {
+  auto& registry = GetRegistry();
+  auto lock = std::lock_guard{ registry.mutex };
+  for( const auto& ring : registry.rings )
+    ring->tail.store( ring->head.load( std::memory_order_acquire ), std::memory_order_relaxed );
+}
+
+#else
+
+auto Summary() -> std::vector<StageStats> { return {}; }
+auto ExportChromeTrace( const std::string& ) -> void {}
+auto Clear() -> void {}
+
+#endif
+
+auto Report( std::FILE* out ) -> void {
+  std::fprintf( out, "%-28s %8s %10s %10s %10s\n", "stage", "count", "p50 [ms]", "p99 [ms]", "max [ms]" );
+  for( const auto& stage : Summary() )
+    std::fprintf( out, "%-28s %8zu %10.3f %10.3f %10.3f\n", stage.name.c_str(), stage.count, stage.p50, stage.p99, stage.max );
+}
+
+}
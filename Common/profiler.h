@@ -0,0 +1,65 @@
+#ifndef PROFILER_H
+#define PROFILER_H
+
+#include <cstdint>
+#include <cstdio>
+#include <string>
+#include <vector>
+
+// Per-stage frame timings. PROFILE_SCOPE( "Stage" ) times the enclosing block and appends one
+// event to a ring buffer owned by the calling thread, so recording takes two clock reads and no
+// lock. Summary() and ExportChromeTrace() read the events of all threads still in the rings.
+//
+// Profiling is compiled in only with PROFILER_ENABLED (CMake option ENABLE_PROFILER); without it
+// PROFILE_SCOPE expands to nothing and the Profiler functions return empty results.
+#ifdef PROFILER_ENABLED
+#define PROFILE_CONCAT_( a, b ) a##b
+#define PROFILE_CONCAT( a, b ) PROFILE_CONCAT_( a, b )
+#define PROFILE_SCOPE( name ) Profiler::ScopedTimer PROFILE_CONCAT( profile_scope_, __LINE__ ){ name }
+#else
+#define PROFILE_SCOPE( name ) static_cast<void>( 0 )
+#endif
+
+namespace Profiler{
+
+// Events kept per thread; older ones are overwritten.
+constexpr size_t RING_SIZE = size_t{1} << 14;
+
+struct StageStats{
+  std::string name{};
+  size_t count{};
+  double p50{};
+  double p99{};
+  double max{};
+};
+
+// Durations in milliseconds, one entry per stage name, sorted by name.
+auto Summary() -> std::vector<StageStats>;
+// Writes Summary() as a table.
+auto Report( std::FILE* out = stdout ) -> void;
+// Chrome trace-event JSON, viewable in chrome://tracing or Perfetto. Throws std::runtime_error if
+// the file cannot be written.
+auto ExportChromeTrace( const std::string& path ) -> void;
+// Forgets the events recorded so far.
+auto Clear() -> void;
+
+#ifdef PROFILER_ENABLED
+// name must outlive the profiler, e.g. a string literal.
+auto Record( const char* name, int64_t begin_ns, int64_t end_ns ) noexcept -> void;
+auto Now() noexcept -> int64_t;
+
+class ScopedTimer{
+public:
+  explicit ScopedTimer( const char* name ) noexcept : name_{name}, begin_{ Now() } {}
+  ScopedTimer( const ScopedTimer& ) = delete;
+  ScopedTimer& operator=( const ScopedTimer& ) = delete;
+  ~ScopedTimer(){ Record( name_, begin_, Now() ); }
+private:
+  const char* name_;
+  int64_t begin_;
+};
+#endif
+
+}
+
+#endif // PROFILER_H
@@ -0,0 +1,46 @@
+#ifndef RING_BUFFER_H
+#define RING_BUFFER_H
+
+#include <array>
+#include <atomic>
+#include <cstddef>
+
+// Fixed-capacity single-producer single-consumer queue. Push never blocks: when the queue is full
+// the item is refused. The consumer reads items in place through Front() and releases them with
+// Pop(), so nothing is copied out.
+template<typename T, size_t CAPACITY>
+class RingBuffer{
+  static_assert( CAPACITY > 0 && ( CAPACITY & ( CAPACITY - 1 ) ) == 0, "RingBuffer capacity must be a power of two" );
+public:
+  RingBuffer() = default;
+  RingBuffer( const RingBuffer& ) = delete;
+  RingBuffer& operator=( const RingBuffer& ) = delete;
+
+  // Producer side; returns false if the queue is full.
+  auto Push( const T& item ) noexcept -> bool {
+    auto tail = tail_.load( std::memory_order_relaxed );
+    if( tail - head_.load( std::memory_order_acquire ) == CAPACITY )
+      return false;
+    items_[ tail & MASK ] = item;
+    tail_.store( tail + 1, std::memory_order_release );
+    return true;
+  }
+
+  // Consumer side. Front() is nullptr when the queue is empty; the item stays valid until Pop().
+  auto Front() noexcept -> const T* {
+    auto head = head_.load( std::memory_order_relaxed );
+    return head == tail_.load( std::memory_order_acquire ) ? nullptr : &items_[ head & MASK ];
+  }
+  auto Pop() noexcept -> void { head_.store( head_.load( std::memory_order_relaxed ) + 1, std::memory_order_release ); }
+
+  auto Size() const noexcept -> size_t { return tail_.load( std::memory_order_acquire ) - head_.load( std::memory_order_acquire ); }
+  static constexpr auto Capacity() noexcept -> size_t { return CAPACITY; }
+
+private:
+  static constexpr size_t MASK = CAPACITY - 1;
+  std::array<T, CAPACITY> items_{};
+  alignas(64) std::atomic<size_t> head_{0};
+  alignas(64) std::atomic<size_t> tail_{0};
+};
+
+#endif // RING_BUFFER_H
@@ -0,0 +1,105 @@
+#include "thread_pool.h"
+
+#include <algorithm>
+
+ThreadPool::ThreadPool( size_t n_threads ){
+  n_threads = std::max( n_threads, size_t{1} );
+  for( size_t i=0; i<n_threads; ++i )
+    queues_.emplace_back( std::make_unique<Queue>() );
+  for( size_t i=1; i<n_threads; ++i )
+    workers_.emplace_back( [this, i](){ WorkerLoop(i); } );
+}
+
+ThreadPool::~ThreadPool(){
+  {
+    auto lock = std::lock_guard{mutex_};
+    stop_ = true;
+  }
+  wake_.notify_all();
+  for( auto& w : workers_ )
+    w.join();
+}
+
+auto ThreadPool::ParallelFor( size_t begin, size_t end, size_t grain, const RangeFunction& func ) -> void {
+  if( begin >= end )
+    return;
+  grain = std::max( grain, size_t{1} );
+  auto n_chunks = ( end - begin + grain - 1 ) / grain;
+  if( workers_.empty() || n_chunks == 1 ){
+    func( begin, end );
+    return;
+  }
+  auto submit_lock = std::lock_guard{submit_mutex_};
+  {
+    auto lock = std::lock_guard{mutex_};
+    remaining_ = n_chunks;
+    job_ = &func;
+  }
+  // Contiguous blocks of chunks per worker keep neighbouring bodies on one core until stealing starts.
+  auto n_queues = queues_.size();
+  for( size_t q=0; q<n_queues; ++q ){
+    auto first = n_chunks * q / n_queues;
+    auto last = n_chunks * (q+1) / n_queues;
+    auto lock = std::lock_guard{queues_[q]->mutex};
+    for( auto c=first; c<last; ++c )
+      queues_[q]->ranges.emplace_back( begin + c*grain, std::min( end, begin + (c+1)*grain ) );
+  }
+  {
+    auto lock = std::lock_guard{mutex_};
+    ++generation_;
+  }
+  wake_.notify_all();
+  RunTasks(0);
+  auto lock = std::unique_lock{mutex_};
+  done_.wait( lock, [this](){ return remaining_ == 0; } );
+  job_ = nullptr;
+}
+
+auto ThreadPool::WorkerLoop( size_t id ) -> void {
+  auto seen = size_t{0};
+  while( true ){
+    {
+      auto lock = std::unique_lock{mutex_};
+      wake_.wait( lock, [this, seen](){ return stop_ || generation_ != seen; } );
+      if( stop_ )
+        return;
+      seen = generation_;
+    }
+    RunTasks(id);
+  }
+}
+
+auto ThreadPool::RunTasks( size_t id ) -> void {
+  auto range = Range{};
+  while( Pop(id, range) || Steal(id, range) ){
+    (*job_)( range.first, range.second );
+    if( remaining_.fetch_sub(1) == 1 ){
+      auto lock = std::lock_guard{mutex_};
+      done_.notify_all();
+    }
+  }
+}
+
+auto ThreadPool::Pop( size_t id, Range& range ) -> bool {
+  auto& q = *queues_[id];
+  auto lock = std::lock_guard{q.mutex};
+  if( q.ranges.empty() )
+    return false;
+  range = q.ranges.front();
+  q.ranges.pop_front();
+  return true;
+}
+
+auto ThreadPool::Steal( size_t id, Range& range ) -> bool {
+  auto n_queues = queues_.size();
+  for( size_t k=1; k<n_queues; ++k ){
+    auto& q = *queues_[ (id + k) % n_queues ];
+    auto lock = std::lock_guard{q.mutex};
+    if( q.ranges.empty() )
+      continue;
+    range = q.ranges.back();
+    q.ranges.pop_back();
+    return true;
+  }
+  return false;
+}
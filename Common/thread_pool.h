@@ -0,0 +1,51 @@
+#ifndef THREAD_POOL_H
+#define THREAD_POOL_H
+
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <utility>
+#include <vector>
+
+// Fixed set of workers that execute ParallelFor ranges. Every worker owns a deque of chunks and
+// steals from the others when its own runs dry, so uneven per-chunk cost evens out across cores.
+// The calling thread takes part as worker 0.
+class ThreadPool{
+public:
+  using RangeFunction = std::function<void(size_t, size_t)>;
+  explicit ThreadPool( size_t n_threads = std::thread::hardware_concurrency() );
+  ~ThreadPool();
+  ThreadPool( const ThreadPool& ) = delete;
+  ThreadPool& operator=( const ThreadPool& ) = delete;
+
+  auto GetThreadCount() const noexcept -> size_t { return queues_.size(); }
+  auto ParallelFor( size_t begin, size_t end, size_t grain, const RangeFunction& func ) -> void;
+
+private:
+  using Range = std::pair<size_t, size_t>;
+  struct Queue{
+    std::mutex mutex;
+    std::deque<Range> ranges;
+  };
+  auto WorkerLoop( size_t id ) -> void;
+  auto RunTasks( size_t id ) -> void;
+  auto Pop( size_t id, Range& range ) -> bool;
+  auto Steal( size_t id, Range& range ) -> bool;
+
+  std::vector<std::unique_ptr<Queue>> queues_{};
+  std::vector<std::thread> workers_{};
+  std::mutex submit_mutex_{};
+  std::mutex mutex_{};
+  std::condition_variable wake_{};
+  std::condition_variable done_{};
+  const RangeFunction* job_{nullptr};
+  size_t generation_{0};
+  std::atomic<size_t> remaining_{0};
+  bool stop_{false};
+};
+
+#endif // THREAD_POOL_H
@@ -0,0 +1,49 @@
+#ifndef TRIPLE_BUFFER_H
+#define TRIPLE_BUFFER_H
+
+#include <array>
+#include <atomic>
+#include <cstdint>
+
+// Single-producer single-consumer handoff of whole frames. The writer fills its private buffer and
+// publishes it by swapping it with the shared "latest" slot; the reader swaps its own buffer with
+// that slot whenever a fresh frame is there. Neither side ever waits on the other: the writer may
+// overwrite unread frames, and the reader keeps returning its last frame until a new one arrives.
+template<typename T>
+class TripleBuffer{
+public:
+  TripleBuffer() = default;
+  explicit TripleBuffer( const T& initial ) : buffers_{ initial, initial, initial } {}
+  TripleBuffer( const TripleBuffer& ) = delete;
+  TripleBuffer& operator=( const TripleBuffer& ) = delete;
+
+  // Writer side.
+  auto GetWriteBuffer() noexcept -> T& { return buffers_[write_]; }
+  // Returns false if the frame it replaces was never read, i.e. that frame was dropped.
+  auto Publish() noexcept -> bool {
+    auto previous = latest_.exchange( write_ | FRESH, std::memory_order_acq_rel );
+    write_ = previous & INDEX;
+    return !( previous & FRESH );
+  }
+
+  // Reader side. The returned reference stays valid until the next call to Read().
+  auto Read() noexcept -> const T& {
+    if( HasUpdate() ){
+      auto previous = latest_.exchange( read_, std::memory_order_acq_rel );
+      read_ = previous & INDEX;
+    }
+    return buffers_[read_];
+  }
+  auto HasUpdate() const noexcept -> bool { return latest_.load( std::memory_order_relaxed ) & FRESH; }
+
+private:
+  static constexpr uint8_t INDEX = 0b011;
+  static constexpr uint8_t FRESH = 0b100;
+
+  std::array<T, 3> buffers_{};
+  alignas(64) std::atomic<uint8_t> latest_{1};
+  alignas(64) uint8_t write_{0};
+  alignas(64) uint8_t read_{2};
+};
+
+#endif // TRIPLE_BUFFER_H
@@ -1,34 +1,26 @@
 #ifndef CAMERA_CONTROL_H
 #define CAMERA_CONTROL_H
 
-#include <array>
+#include <cmath>
 #include <functional>
 
-#include <SFML/Window/Mouse.hpp>
-#include <SFML/Window/Window.hpp>
-#include <vector>
-
 #include "coordinates.h"
 #include "camera.h"
 #include "mouse.h"
 
 
+// Dragging with the left button moves the view along with the cursor; the wheel zooms around
+// the view's center.
 class CameraControl{
 public:
   CameraControl() = default;
   auto Update(){
-    mouse_request_();
-    if( mouse_events_.size() < 2 )
-      return;
-    auto ev_1 = mouse_events_.at( mouse_events_.size() - 2 );
-    auto ev_2 = mouse_events_.at( mouse_events_.size() - 1 );
-    if( ev_1.what != MouseEvent::EventType::LEFT_CLICK || ev_2.what != MouseEvent::EventType::LEFT_CLICK )
+    const auto& mouse = mouse_request_();
+    if( mouse.drag == Point2D{} && mouse.wheel == 0.0 )
       return;
     camera_request_();
-    auto translation = ev_2.position - ev_1.position;
-    // translation*=0.1;
-    auto new_position = camera_position_ - translation;
-    camera_position_ = new_position;
+    camera_position_ -= mouse.drag * ( 1.0 / pixel_scale_ );
+    camera_size_ *= std::pow( ZOOM_PER_TICK, mouse.wheel );
     camera_callback_();
   }
   auto RegisterCamera(Camera& cam){ 
@@ -38,8 +30,9 @@ public:
   auto RegisterMouse( Mouse& mouse ){
     mouse_request_ = GenerateMouseRequest(mouse);
   }
-  auto SetMouseEvents( std::vector<MouseEvent> events ){ mouse_events_.swap(events); }
 private:
+  // Factor applied to the view size per wheel tick away from the user.
+  static constexpr double ZOOM_PER_TICK = 0.9;
   auto GenerateCameraNotification(Camera& cam) -> std::function<void(void)> {
     return [&cam, this](){ 
       cam.MoveCamera( camera_position_ );
@@ -51,17 +44,18 @@ private:
     return [&cam, this](){ 
       camera_position_ = cam.GetPoistion();
       camera_size_ = cam.GetSize();
+      pixel_scale_ = cam.GetPixelScale();
     };
   }
-  auto GenerateMouseRequest( Mouse& mouse ) -> std::function<void(void)> {
-    return [&mouse, this](){ mouse_events_ = mouse.GetEvents(); };
+  auto GenerateMouseRequest( Mouse& mouse ) -> std::function<const MouseState&(void)> {
+    return [&mouse]() -> const MouseState& { return mouse.GetState(); };
   }
   Point2D camera_position_;
   Point2D camera_size_;
-  std::vector<MouseEvent> mouse_events_{};
+  double pixel_scale_{1.0};
   std::function<void(void)> camera_callback_{};
   std::function<void(void)> camera_request_{};
-  std::function<void(void)> mouse_request_{};
+  std::function<const MouseState&(void)> mouse_request_{};
 };
 
-#endif
\ No newline at end of file
+#endif
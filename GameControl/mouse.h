@@ -1,58 +1,69 @@
 #ifndef MOUSE_H
 #define MOUSE_H
 
-#include "coordinates.h"
 #include <SFML/Window/Event.hpp>
-#include <SFML/Window/Window.hpp>
-#include <mutex>
-#include <vector>
-
 #include <SFML/Window/Mouse.hpp>
 
-struct MouseEvent{
-  enum class EventType{
-    RIGHT_CLICK,
-    LEFT_CLICK,
-    NOTHING
-  };
-  Point2D position;
-  EventType what{MouseEvent::EventType::NOTHING};
-  auto Print(){
-    switch (what) {
-      case EventType::RIGHT_CLICK:
-        std::cout << "Right << ";
-        break;
-      case EventType::LEFT_CLICK:
-        std::cout << "Left << ";
-        break;
-      case EventType::NOTHING:
-        std::cout << "Nothing << ";
-        break;
-    }
-    position.Print();
-  }
+#include "coordinates.h"
+#include "window.h"
+
+// Mouse input gathered from the window's events. Positions are in pixels; drag and wheel are the
+// motion since the previous Listen.
+struct MouseState{
+  Point2D position{};
+  // Movement while the left button was held.
+  Point2D drag{};
+  // Wheel ticks, positive when turned away from the user.
+  double wheel{0.0};
+  bool left{false};
+  bool right{false};
 };
 
+// Sole consumer of a Window's event queue. Listen drains the queue; the state is read in place.
 class Mouse{
 public:
-  Mouse( const sf::Window& w ) : window_(w) { mouse_events_.resize(10); };
-  auto GetEvents() const noexcept -> const std::vector<MouseEvent>& { return mouse_events_; }
+  Mouse( Window& w ) : events_(w.GetEvents()) {};
+  auto GetState() const noexcept -> const MouseState& { return state_; }
   auto Listen() -> void { 
-    if( mouse_events_.size() > 10 )
-      mouse_events_.clear();
-    auto new_event = MouseEvent{};
-    new_event.position = Point2D{ sf::Mouse::getPosition(window_) };
-    if( sf::Mouse::isButtonPressed(sf::Mouse::Left) )
-      new_event.what = MouseEvent::EventType::LEFT_CLICK;
-    if( sf::Mouse::isButtonPressed(sf::Mouse::Right) )
-      new_event.what = MouseEvent::EventType::RIGHT_CLICK;
-    new_event.Print();
-    mouse_events_.push_back(std::move(new_event));
+    state_.drag = {};
+    state_.wheel = 0.0;
+    for( auto event = events_.Front(); event; events_.Pop(), event = events_.Front() )
+      Handle( *event );
   }
 private:
-  const sf::Window& window_;
-  std::mutex mutex;
-  std::vector<MouseEvent> mouse_events_;
+  auto Handle( const sf::Event& event ) -> void {
+    switch( event.type ){
+      case sf::Event::MouseMoved: {
+        auto position = Point2D{ static_cast<double>( event.mouseMove.x ), static_cast<double>( event.mouseMove.y ) };
+        if( state_.left )
+          state_.drag += position - state_.position;
+        state_.position = position;
+        break;
+      }
+      case sf::Event::MouseButtonPressed:
+      case sf::Event::MouseButtonReleased: {
+        auto pressed = event.type == sf::Event::MouseButtonPressed;
+        state_.position = Point2D{ static_cast<double>( event.mouseButton.x ), static_cast<double>( event.mouseButton.y ) };
+        if( event.mouseButton.button == sf::Mouse::Left )
+          state_.left = pressed;
+        if( event.mouseButton.button == sf::Mouse::Right )
+          state_.right = pressed;
+        break;
+      }
+      case sf::Event::MouseWheelScrolled:
+        if( event.mouseWheelScroll.wheel == sf::Mouse::VerticalWheel )
+          state_.wheel += event.mouseWheelScroll.delta;
+        break;
+      case sf::Event::MouseLeft:
+        state_.left = false;
+        state_.right = false;
+        break;
+      default:
+        break;
+    }
+  }
+  Window::EventQueue& events_;
+  MouseState state_{};
 };
 
-#endif
\ No newline at end of file
+#endif
@@ -0,0 +1,47 @@
+#ifndef BOUNDING_BOX_H
+#define BOUNDING_BOX_H
+
+#include <algorithm>
+#include <limits>
+
+#include "coordinates.h"
+#include "transform.h"
+
+// Axis-aligned box; the default one is empty and intersects nothing.
+struct BoundingBox{
+  Point2D min{ std::numeric_limits<double>::max(), std::numeric_limits<double>::max() };
+  Point2D max{ std::numeric_limits<double>::lowest(), std::numeric_limits<double>::lowest() };
+
+  static auto FromCenter( const Point2D& center, const Point2D& size ) noexcept -> BoundingBox {
+    return { center - size / 2.0, center + size / 2.0 };
+  }
+  auto IsEmpty() const noexcept -> bool { return min.x > max.x || min.y > max.y; }
+  auto Center() const noexcept -> Point2D { return ( min + max ) / 2.0; }
+  auto Size() const noexcept -> Point2D { return max - min; }
+  auto Intersects( const BoundingBox& other ) const noexcept -> bool {
+    return min.x <= other.max.x && other.min.x <= max.x && min.y <= other.max.y && other.min.y <= max.y;
+  }
+  auto Expand( const Point2D& p ) noexcept -> BoundingBox& {
+    min = { std::min( min.x, p.x ), std::min( min.y, p.y ) };
+    max = { std::max( max.x, p.x ), std::max( max.y, p.y ) };
+    return *this;
+  }
+  auto Expand( const BoundingBox& other ) noexcept -> BoundingBox& {
+    if( !other.IsEmpty() ){
+      Expand( other.min );
+      Expand( other.max );
+    }
+    return *this;
+  }
+  // Box around the four transformed corners; it contains the transformed contents of this box.
+  auto Transformed( const Transform& transform ) const noexcept -> BoundingBox {
+    if( IsEmpty() )
+      return {};
+    auto box = BoundingBox{};
+    box.Expand( transform.Apply( min ) ).Expand( transform.Apply( max ) );
+    box.Expand( transform.Apply( { min.x, max.y } ) ).Expand( transform.Apply( { max.x, min.y } ) );
+    return box;
+  }
+};
+
+#endif // BOUNDING_BOX_H
@@ -3,6 +3,7 @@
 
 #include <SFML/Graphics/View.hpp>
 
+#include "bounding_box.h"
 #include "coordinates.h"
 #include "window.h"
 
@@ -12,6 +13,7 @@ public:
     GenerateNotification( w );
     view_.setCenter( Point2D{0.0, 0.0}.SfVector() );
     view_.setSize( Point2D{(*w).getSize()}.SfVector() );
+    pixels_ = Point2D{(*w).getSize()};
   };
 
   auto MoveCamera( const Point2D& where_to ) -> void{ view_.setCenter( where_to.SfVector() ); }
@@ -26,10 +28,15 @@ public:
 
   auto GetPoistion() -> Point2D { return Point2D(view_.getCenter()); }
   auto GetSize() -> Point2D { return Point2D(view_.getSize()); }
+  // World-space rectangle the view shows.
+  auto GetViewBox() -> BoundingBox { return BoundingBox::FromCenter( GetPoistion(), GetSize() ); }
+  // Pixels per world unit along x.
+  auto GetPixelScale() -> double { return pixels_.x / GetSize().x; }
 
 private:
   auto GenerateNotification( Window& w ) -> std::function<void(void)> { return [&w, this]() mutable{ w.SetView( view_ ); }; }
   sf::View view_{};
+  Point2D pixels_{};
   std::function<void(void)> window_notification_{};
 };
 
@@ -0,0 +1,51 @@
+#include "circle_mesh.h"
+
+#include <algorithm>
+#include <array>
+#include <bit>
+#include <cmath>
+
+namespace CircleMesh{
+
+namespace {
+
+constexpr size_t N_LEVELS = std::bit_width( MAX_SEGMENTS ) - std::bit_width( MIN_SEGMENTS ) + 1;
+
+auto Circle( size_t segments ) -> std::vector<Point2D> {
+  auto points = std::vector<Point2D>{};
+  points.reserve( segments );
+  auto dphi = 2*M_PI / segments;
+  for( size_t i=0; i<segments; ++i )
+    points.emplace_back( std::cos( dphi*i ), std::sin( dphi*i ) );
+  return points;
+}
+
+}
+
+auto Segments( double screen_radius ) noexcept -> size_t {
+  if( !( screen_radius >= POINT_RADIUS ) )
+    return POINT_SPRITE;
+  // A chord of a circle with n segments stays within r( 1 - cos(pi/n) ) ~ r pi^2 / 2n^2 of it.
+  auto n = M_PI * std::sqrt( screen_radius / ( 2*TOLERANCE ) );
+  if( n >= static_cast<double>( MAX_SEGMENTS ) )
+    return MAX_SEGMENTS;
+  return std::max( MIN_SEGMENTS, std::bit_ceil( static_cast<size_t>( std::ceil(n) ) ) );
+}
+
+auto Get( size_t segments ) -> const std::vector<Point2D>& {
+  static const auto meshes = [](){
+    auto meshes = std::array<std::vector<Point2D>, N_LEVELS>{};
+    for( size_t level=0; level<N_LEVELS; ++level )
+      meshes[level] = Circle( MIN_SEGMENTS << level );
+    return meshes;
+  }();
+  segments = std::clamp( std::bit_ceil( segments ), MIN_SEGMENTS, MAX_SEGMENTS );
+  return meshes[ std::bit_width( segments ) - std::bit_width( MIN_SEGMENTS ) ];
+}
+
+auto Sprite() -> const std::vector<Point2D>& {
+  static const auto sprite = Circle( 3 );
+  return sprite;
+}
+
+}
@@ -0,0 +1,32 @@
+#ifndef CIRCLE_MESH_H
+#define CIRCLE_MESH_H
+
+#include <cstddef>
+#include <vector>
+
+#include "coordinates.h"
+
+// Shared unit circles for drawing circular polygons at a detail that follows their size on screen.
+namespace CircleMesh{
+
+// Segment counts are powers of two between these bounds.
+constexpr size_t MIN_SEGMENTS = 4;
+constexpr size_t MAX_SEGMENTS = 256;
+// Largest distance, in pixels, allowed between the true circle and its mesh.
+constexpr double TOLERANCE = 0.25;
+// Circles with a smaller on-screen radius, in pixels, are drawn as a point sprite of that radius.
+constexpr double POINT_RADIUS = 1.0;
+
+// Returns of Segments besides a segment count.
+constexpr size_t OWN_POINTS = 0;
+constexpr size_t POINT_SPRITE = 1;
+
+auto Segments( double screen_radius ) noexcept -> size_t;
+// Unit circle with the given number of segments, starting at angle 0 like Polygon's circle constructor.
+auto Get( size_t segments ) -> const std::vector<Point2D>&;
+// Unit triangle drawn for a point sprite.
+auto Sprite() -> const std::vector<Point2D>&;
+
+}
+
+#endif // CIRCLE_MESH_H
@@ -15,7 +15,6 @@ int main(){
   while (!w.Exit()) {
     shape.RotateCM(0.01);
     vis.AddToQueue(shape);
-    vis.Render();
     vis.Notify();
     w.Update();
   }
@@ -0,0 +1,196 @@
+#include "headless_target.h"
+
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <cstring>
+#include <stdexcept>
+#include <utility>
+
+namespace {
+
+using File = std::unique_ptr<std::FILE, int(*)(std::FILE*)>;
+
+auto Open( const std::string& path, const char* mode ) -> File {
+  auto file = File{ std::fopen( path.c_str(), mode ), &std::fclose };
+  if( !file )
+    throw std::runtime_error( "HeadlessTarget: cannot open " + path );
+  return file;
+}
+
+auto Crc32( const uint8_t* data, size_t size, uint32_t crc = 0 ) noexcept -> uint32_t {
+  static const auto table = [](){
+    auto table = std::array<uint32_t, 256>{};
+    for( uint32_t n=0; n<256; ++n ){
+      auto c = n;
+      for( int k=0; k<8; ++k )
+        c = c & 1 ? 0xedb88320u ^ ( c >> 1 ) : c >> 1;
+      table[n] = c;
+    }
+    return table;
+  }();
+  crc = ~crc;
+  for( size_t i=0; i<size; ++i )
+    crc = table[ ( crc ^ data[i] ) & 0xff ] ^ ( crc >> 8 );
+  return ~crc;
+}
+
+auto PutBigEndian( std::vector<uint8_t>& out, uint32_t value ) -> void {
+  for( int shift=24; shift>=0; shift-=8 )
+    out.push_back( static_cast<uint8_t>( value >> shift ) );
+}
+
+auto WriteChunk( std::FILE* file, const char* type, const std::vector<uint8_t>& data ) -> bool {
+  auto header = std::vector<uint8_t>{};
+  PutBigEndian( header, static_cast<uint32_t>( data.size() ) );
+  header.insert( header.end(), type, type + 4 );
+  auto crc = Crc32( header.data() + 4, 4 );
+  crc = Crc32( data.data(), data.size(), crc );
+  auto trailer = std::vector<uint8_t>{};
+  PutBigEndian( trailer, crc );
+  return std::fwrite( header.data(), 1, header.size(), file ) == header.size()
+      && std::fwrite( data.data(), 1, data.size(), file ) == data.size()
+      && std::fwrite( trailer.data(), 1, trailer.size(), file ) == trailer.size();
+}
+
+}
+
+HeadlessTarget::HeadlessTarget( size_t width, size_t height ) : 
+  width_{width}, height_{height}, pixels_( width * height ), background_{ Pack( sf::Color::White ) } {
+  view_.setCenter( sf::Vector2f( width / 2.0f, height / 2.0f ) );
+  view_.setSize( sf::Vector2f( static_cast<float>(width), static_cast<float>(height) ) );
+}
+
+auto HeadlessTarget::Pack( sf::Color color ) noexcept -> uint32_t {
+  const uint8_t bytes[4] = { color.r, color.g, color.b, color.a };
+  auto packed = uint32_t{};
+  std::memcpy( &packed, bytes, sizeof(packed) );
+  return packed;
+}
+
+auto HeadlessTarget::Update() -> void {
+  if( fresh_ ){
+    Rasterize();
+    fresh_ = false;
+  }
+  if( recording_ )
+    Write();
+  ++frame_count_;
+}
+
+auto HeadlessTarget::Record( Format format, const std::string& path ) -> void {
+  StopRecording();
+  format_ = format;
+  path_ = path;
+  if( format == Format::RAW )
+    raw_ = Open( path, "wb" );
+  recording_ = true;
+}
+
+// Triangles are filled flat with the color of their first vertex, which is the color of the whole
+// polygon for everything RenderEngine produces, and opaque, like the shapes drawn by Window.
+auto HeadlessTarget::Rasterize() -> void {
+  std::fill( pixels_.begin(), pixels_.end(), background_ );
+  auto size = view_.getSize();
+  auto origin = sf::Vector2f( view_.getCenter().x - size.x / 2, view_.getCenter().y - size.y / 2 );
+  auto scale = sf::Vector2f( width_ / size.x, height_ / size.y );
+  auto map = [&origin, &scale]( const sf::Vertex& v ){ 
+    return sf::Vector2f( ( v.position.x - origin.x ) * scale.x, ( v.position.y - origin.y ) * scale.y ); 
+  };
+  for( size_t i=0; i+2<frame_.getVertexCount(); i+=3 )
+    FillTriangle( map( frame_[i] ), map( frame_[i+1] ), map( frame_[i+2] ), Pack( frame_[i].color ) );
+}
+
+// Scanline fill of the pixels whose centers lie inside the triangle, with half-open spans on both
+// axes, so triangles sharing an edge neither overlap nor leave a gap. Each span is one std::fill_n
+// over contiguous pixels, which the compiler turns into vector stores.
+auto HeadlessTarget::FillTriangle( sf::Vector2f a, sf::Vector2f b, sf::Vector2f c, uint32_t color ) noexcept -> void {
+  if( a.y > b.y ) std::swap( a, b );
+  if( b.y > c.y ) std::swap( b, c );
+  if( a.y > b.y ) std::swap( a, b );
+  auto row_begin = std::max( 0.0, std::ceil( a.y - 0.5 ) );
+  auto row_end = std::min( static_cast<double>( height_ ), std::ceil( c.y - 0.5 ) );
+  auto at = []( const sf::Vector2f& p, const sf::Vector2f& q, double y ){ return p.x + ( y - p.y ) * ( q.x - p.x ) / ( q.y - p.y ); };
+  for( auto row=row_begin; row<row_end; ++row ){
+    auto y = row + 0.5;
+    auto x_long = at( a, c, y );
+    auto x_short = y < b.y ? at( a, b, y ) : at( b, c, y );
+    auto x_begin = std::max( 0.0, std::ceil( std::min( x_long, x_short ) - 0.5 ) );
+    auto x_end = std::min( static_cast<double>( width_ ), std::ceil( std::max( x_long, x_short ) - 0.5 ) );
+    if( x_begin < x_end )
+      std::fill_n( pixels_.data() + static_cast<size_t>(row) * width_ + static_cast<size_t>(x_begin), 
+                   static_cast<size_t>( x_end - x_begin ), color );
+  }
+}
+
+auto HeadlessTarget::Write() -> void {
+  auto ok = true;
+  if( format_ == Format::RAW ){
+    ok = std::fwrite( pixels_.data(), sizeof(uint32_t), pixels_.size(), raw_.get() ) == pixels_.size();
+  } else {
+    auto name = std::vector<char>( path_.size() + 32 );
+    std::snprintf( name.data(), name.size(), path_.c_str(), static_cast<int>( frame_count_ ) );
+    auto file = Open( name.data(), "wb" );
+    ok = format_ == Format::PPM ? WritePpm( file.get() ) : WritePng( file.get() );
+  }
+  if( !ok )
+    throw std::runtime_error( "HeadlessTarget: write to " + path_ + " failed" );
+}
+
+auto HeadlessTarget::WritePpm( std::FILE* file ) -> bool {
+  auto& rgb = scratch_;
+  rgb.resize( 3 * pixels_.size() );
+  const auto* rgba = reinterpret_cast<const uint8_t*>( pixels_.data() );
+  for( size_t i=0; i<pixels_.size(); ++i )
+    std::memcpy( rgb.data() + 3*i, rgba + 4*i, 3 );
+  return std::fprintf( file, "P6\n%zu %zu\n255\n", width_, height_ ) > 0
+      && std::fwrite( rgb.data(), 1, rgb.size(), file ) == rgb.size();
+}
+
+// The image data goes into stored (uncompressed) deflate blocks: no zlib needed, and writing
+// costs little more than a raw frame.
+auto HeadlessTarget::WritePng( std::FILE* file ) -> bool {
+  static constexpr uint8_t SIGNATURE[8] = { 0x89, 'P', 'N', 'G', '\r', '\n', 0x1a, '\n' };
+  static constexpr size_t MAX_BLOCK = 65535;
+  auto header = std::vector<uint8_t>{};
+  PutBigEndian( header, static_cast<uint32_t>( width_ ) );
+  PutBigEndian( header, static_cast<uint32_t>( height_ ) );
+  header.insert( header.end(), { 8, 6, 0, 0, 0 } );  // 8 bit RGBA, deflate, no filter, no interlace
+
+  auto& scanlines = scratch_;
+  auto stride = 4 * width_;
+  scanlines.resize( height_ * ( stride + 1 ) );
+  const auto* rgba = reinterpret_cast<const uint8_t*>( pixels_.data() );
+  for( size_t row=0; row<height_; ++row ){
+    scanlines[ row * ( stride + 1 ) ] = 0;
+    std::memcpy( scanlines.data() + row * ( stride + 1 ) + 1, rgba + row * stride, stride );
+  }
+
+  auto data = std::vector<uint8_t>{ 0x78, 0x01 };
+  data.reserve( scanlines.size() + 5 * ( scanlines.size() / MAX_BLOCK + 1 ) + 6 );
+  uint32_t s1 = 1, s2 = 0;
+  for( size_t begin=0; begin<scanlines.size() || begin==0; begin+=MAX_BLOCK ){
+    auto size = std::min( MAX_BLOCK, scanlines.size() - begin );
+    auto last = begin + size == scanlines.size();
+    data.insert( data.end(), { static_cast<uint8_t>( last ), static_cast<uint8_t>( size ), static_cast<uint8_t>( size >> 8 ),
+                               static_cast<uint8_t>( ~size ), static_cast<uint8_t>( ~size >> 8 ) } );
+    data.insert( data.end(), scanlines.begin() + begin, scanlines.begin() + begin + size );
+    // Adler-32; 5552 bytes is the most that can be summed before the 32 bit sums could overflow.
+    for( auto run=begin; run<begin+size; run+=5552 ){
+      for( auto i=run; i<std::min( run+5552, begin+size ); ++i ){
+        s1 += scanlines[i];
+        s2 += s1;
+      }
+      s1 %= 65521;
+      s2 %= 65521;
+    }
+    if( last )
+      break;
+  }
+  PutBigEndian( data, ( s2 << 16 ) | s1 );
+
+  return std::fwrite( SIGNATURE, 1, sizeof(SIGNATURE), file ) == sizeof(SIGNATURE)
+      && WriteChunk( file, "IHDR", header )
+      && WriteChunk( file, "IDAT", data )
+      && WriteChunk( file, "IEND", {} );
+}
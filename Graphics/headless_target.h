@@ -0,0 +1,70 @@
+#ifndef HEADLESS_TARGET_H
+#define HEADLESS_TARGET_H
+
+#include <cstdint>
+#include <cstdio>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include <SFML/Graphics/Color.hpp>
+#include <SFML/Graphics/VertexArray.hpp>
+#include <SFML/Graphics/View.hpp>
+
+// Stand-in for Window where there is no display: frames submitted by a RenderEngine are
+// rasterized in memory into an RGBA framebuffer and, while recording, written to disk on every
+// Update. It needs no window or OpenGL context, so it runs on batch nodes and in CI, as fast as
+// the simulation can produce frames.
+class HeadlessTarget{
+public:
+  enum class Format{
+    PPM,  // one binary PPM (P6) file per frame
+    PNG,  // one uncompressed PNG file per frame
+    RAW   // all frames as packed RGBA into one file, e.g. for ffmpeg -f rawvideo -pix_fmt rgba
+  };
+
+  HeadlessTarget( size_t width, size_t height );
+
+  // Same contract as Window::Submit: the caller gets an old frame back to refill.
+  auto Submit( sf::VertexArray& frame ) -> void { std::swap( frame_, frame ); fresh_ = true; }
+  // World rectangle mapped onto the framebuffer; by default one unit is one pixel, like sf::View.
+  auto SetView( const sf::View& view ) -> void { view_ = view; fresh_ = true; }
+  auto SetBackground( sf::Color color ) -> void { background_ = Pack( color ); fresh_ = true; }
+  // Rasterizes the last submitted frame if it changed, then writes it when recording.
+  auto Update() -> void;
+
+  // For PPM and PNG, path is a printf pattern taking the frame number, e.g. "orbit_%06d.png";
+  // for RAW it is the one output file. Errors throw std::runtime_error.
+  auto Record( Format format, const std::string& path ) -> void;
+  auto StopRecording() -> void { raw_.reset(); recording_ = false; }
+
+  // Row-major, top row first; each pixel holds R, G, B, A in this byte order.
+  auto GetPixels() const noexcept -> const std::vector<uint32_t>& { return pixels_; }
+  auto GetWidth() const noexcept -> size_t { return width_; }
+  auto GetHeight() const noexcept -> size_t { return height_; }
+  auto GetFrameCount() const noexcept -> uint64_t { return frame_count_; }
+
+private:
+  static auto Pack( sf::Color color ) noexcept -> uint32_t;
+  auto Rasterize() -> void;
+  auto FillTriangle( sf::Vector2f a, sf::Vector2f b, sf::Vector2f c, uint32_t color ) noexcept -> void;
+  auto Write() -> void;
+  auto WritePpm( std::FILE* file ) -> bool;
+  auto WritePng( std::FILE* file ) -> bool;
+
+  size_t width_;
+  size_t height_;
+  std::vector<uint32_t> pixels_;
+  std::vector<uint8_t> scratch_{};
+  sf::VertexArray frame_{ sf::Triangles };
+  sf::View view_{};
+  uint32_t background_;
+  bool fresh_{true};
+  bool recording_{false};
+  Format format_{Format::PPM};
+  std::string path_{};
+  std::unique_ptr<std::FILE, int(*)(std::FILE*)> raw_{ nullptr, &std::fclose };
+  uint64_t frame_count_{0};
+};
+
+#endif // HEADLESS_TARGET_H
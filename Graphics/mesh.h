@@ -0,0 +1,48 @@
+#ifndef MESH_H
+#define MESH_H
+
+#include <algorithm>
+#include <memory>
+#include <vector>
+
+#include "bounding_box.h"
+#include "coordinates.h"
+
+class Mesh;
+using MeshHandle = std::shared_ptr<const Mesh>;
+
+// Immutable outline of a convex polygon in its own space. Polygons hold it by handle, so every
+// copy of a Polygon or Shape shares one set of vertices and only adds its transform and color.
+// The triangle fan is built once here; drawing an instance maps it straight into the frame.
+class Mesh{
+public:
+  Mesh( std::vector<Point2D> points, double radius = 0.0 ) : points_{std::move(points)}, radius_{radius} {
+    std::for_each( points_.begin(), points_.end(), [this]( const auto& p ){ center_mass_ += p; box_.Expand(p); } );
+    if( !points_.empty() )
+      center_mass_ /= points_.size();
+    if( radius_ > 0 )
+      box_ = BoundingBox::FromCenter( center_mass_, { 2*radius_, 2*radius_ } );
+    for( size_t i=1; i+1<points_.size(); ++i )
+      triangles_.insert( triangles_.end(), { points_.front(), points_[i], points_[i+1] } );
+  }
+  static auto Create( std::vector<Point2D> points, double radius = 0.0 ) -> MeshHandle {
+    return std::make_shared<const Mesh>( std::move(points), radius );
+  }
+
+  auto GetPoints() const noexcept -> const std::vector<Point2D>& { return points_; }
+  // points.size()-2 triangles, three corners each, empty for fewer than three points.
+  auto GetTriangles() const noexcept -> const std::vector<Point2D>& { return triangles_; }
+  auto GetCenterMass() const noexcept -> const Point2D& { return center_mass_; }
+  auto GetBoundingBox() const noexcept -> const BoundingBox& { return box_; }
+  // Radius of a circle mesh, 0 for any other outline.
+  auto GetRadius() const noexcept -> double { return radius_; }
+
+private:
+  std::vector<Point2D> points_;
+  std::vector<Point2D> triangles_{};
+  Point2D center_mass_{};
+  BoundingBox box_{};
+  double radius_;
+};
+
+#endif // MESH_H
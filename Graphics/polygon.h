@@ -4,7 +4,10 @@
 #include <cmath>
 #include <vector>
 
+#include "bounding_box.h"
 #include "coordinates.h"
+#include "mesh.h"
+#include "transform.h"
 
 struct Color{
   Color() = default;
@@ -18,37 +21,49 @@ struct Color{
 
 class Polygon{
 public:
-  Polygon( std::vector<Point2D> vec_points ) : points_{std::move(vec_points)} { CalculateCM(); }
-  Polygon( Point2D center_mass, double width, double hight ) : center_mass_{center_mass} { 
-    points_.reserve(4);
-    points_.emplace_back( center_mass.x + width/2, center_mass.y + hight/2 );
-    points_.emplace_back( center_mass.x + width/2, center_mass.y - hight/2 );
-    points_.emplace_back( center_mass.x - width/2, center_mass.y - hight/2 );
-    points_.emplace_back( center_mass.x - width/2, center_mass.y + hight/2 );
-  }
+  Polygon( std::vector<Point2D> vec_points ) : mesh_{ Mesh::Create( std::move(vec_points) ) } {}
+  Polygon( Point2D center_mass, double width, double hight ) : mesh_{ Mesh::Create( {
+    { center_mass.x + width/2, center_mass.y + hight/2 },
+    { center_mass.x + width/2, center_mass.y - hight/2 },
+    { center_mass.x - width/2, center_mass.y - hight/2 },
+    { center_mass.x - width/2, center_mass.y + hight/2 } } ) } {}
   Polygon( Point2D center_mass, size_t n_points, double radius ){
-    points_.reserve(n_points);
+    auto points = std::vector<Point2D>{};
+    points.reserve(n_points);
     auto dphi = 2*M_PI / n_points;
     for( size_t i=0; i<n_points; ++i ){
       auto phi = dphi*i;
       auto x = radius*cos(phi);
       auto y = radius*sin(phi);
-      points_.push_back( center_mass+Point2D{x, y} );
+      points.push_back( center_mass+Point2D{x, y} );
     }
+    mesh_ = Mesh::Create( std::move(points), radius );
   }
+  // Another instance of an existing mesh; copying a Polygon shares its mesh the same way.
+  explicit Polygon( MeshHandle mesh ) : mesh_{std::move(mesh)} {}
+  // Translate and Rotate only update the transform; the points are mapped when they are drawn.
   auto Translate( const Point2D& new_cm ) noexcept -> void;
   auto Rotate( const Point2D& rot_point, const double angle ) noexcept  -> void;
   auto RotateCM( const double angle ) noexcept  -> void;
   auto SetColor( Color c ) noexcept -> Polygon& { color_ = std::move(c); return *this; }
+  auto SetTransform( const Transform& transform ) noexcept -> Polygon& { transform_ = transform; return *this; }
   
-  auto GetPoints() const noexcept -> const std::vector<Point2D>& { return points_; }
-  auto GetCenterMass() const noexcept -> const Point2D& { return center_mass_; }
+  auto GetMesh() const noexcept -> const MeshHandle& { return mesh_; }
+  // Vertices in the polygon's own space, before its transform.
+  auto GetPoints() const noexcept -> const std::vector<Point2D>& { return mesh_->GetPoints(); }
+  auto GetTransform() const noexcept -> const Transform& { return transform_; }
+  // Center of mass after the transform, i.e. in the space of the owning Shape.
+  auto GetCenterMass() const noexcept -> Point2D { return transform_.Apply( mesh_->GetCenterMass() ); }
   auto GetColor() const noexcept -> const Color& { return color_; }
+  // Radius of a polygon built as a circle, which the RenderEngine may redraw with more or fewer
+  // segments; 0 for any other polygon.
+  auto GetRadius() const noexcept -> double { return mesh_->GetRadius(); }
+  // Bounds of GetPoints(), or of the whole circle for a circle, before the transform.
+  auto GetLocalBoundingBox() const noexcept -> const BoundingBox& { return mesh_->GetBoundingBox(); }
 
 private:
-  auto CalculateCM() noexcept -> void;
-  std::vector<Point2D> points_;
-  Point2D center_mass_{};
+  MeshHandle mesh_;
+  Transform transform_{};
   Color color_;
 };
 
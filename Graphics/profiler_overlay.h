@@ -0,0 +1,64 @@
+#ifndef PROFILER_OVERLAY_H
+#define PROFILER_OVERLAY_H
+
+#include <cstdint>
+#include <functional>
+#include <string>
+
+#include <SFML/Graphics/Color.hpp>
+#include <SFML/Graphics/RenderTarget.hpp>
+#include <SFML/Graphics/VertexArray.hpp>
+
+#include "profiler.h"
+
+// Bar chart of Profiler::Summary() in the top-left corner, one row per stage in name order: a
+// solid bar to p50, a lighter one on to p99 and a black tick at the max. The full width is one
+// frame at 60 Hz. Stages keep their color, derived from their name, between refreshes.
+class ProfilerOverlay{
+public:
+  ProfilerOverlay() = default;
+  auto Draw( sf::RenderTarget& target ) -> void {
+    if( frame_++ % REFRESH == 0 )
+      Build();
+    auto view = target.getView();
+    target.setView( target.getDefaultView() );
+    target.draw( bars_ );
+    target.setView( view );
+  }
+
+private:
+  static constexpr uint64_t REFRESH = 30;
+  static constexpr float ROW = 8.0f;
+  static constexpr float WIDTH = 300.0f;
+  static constexpr double BUDGET_MS = 1000.0 / 60.0;
+
+  auto Build() -> void {
+    bars_.clear();
+    auto row = 0.0f;
+    for( const auto& stage : Profiler::Summary() ){
+      auto color = Color( stage.name );
+      auto light = sf::Color( color.r, color.g, color.b, 96 );
+      Bar( row, 0.0, stage.p50, color );
+      Bar( row, stage.p50, stage.p99, light );
+      Bar( row, stage.max, stage.max, sf::Color::Black, 2.0f );
+      row += ROW;
+    }
+  }
+  auto Bar( float row, double from_ms, double to_ms, sf::Color color, float min_width = 0.0f ) -> void {
+    auto x0 = static_cast<float>( from_ms / BUDGET_MS ) * WIDTH;
+    auto x1 = std::max( static_cast<float>( to_ms / BUDGET_MS ) * WIDTH, x0 + min_width );
+    auto y0 = row + 1.0f;
+    auto y1 = row + ROW - 1.0f;
+    for( auto [x, y] : { std::pair{x0, y0}, {x1, y0}, {x1, y1}, {x0, y0}, {x1, y1}, {x0, y1} } )
+      bars_.append( sf::Vertex( sf::Vector2f( x, y ), color ) );
+  }
+  static auto Color( const std::string& name ) -> sf::Color {
+    auto hash = std::hash<std::string>{}( name );
+    return sf::Color( 64 + hash % 160, 64 + ( hash >> 8 ) % 160, 64 + ( hash >> 16 ) % 160 );
+  }
+
+  sf::VertexArray bars_{ sf::Triangles };
+  uint64_t frame_{0};
+};
+
+#endif // PROFILER_OVERLAY_H
@@ -2,62 +2,164 @@
 #define RENDER_ENGINE_H
 
 #include <algorithm>
+#include <cmath>
+#include <cstdint>
 #include <functional>
-#include <queue>
+#include <unordered_map>
+#include <utility>
 #include <vector>
 
-#include <SFML/Graphics/ConvexShape.hpp>
+#include <SFML/Graphics/Vertex.hpp>
+#include <SFML/Graphics/VertexArray.hpp>
 
+#include "circle_mesh.h"
+#include "headless_target.h"
 #include "polygon.h"
+#include "profiler.h"
 #include "shape.h"
+#include "transform.h"
 #include "window.h"
 
-
+// Collects a frame as one triangle list and hands it to the Window, which draws it in a single
+// call, shapes in the order they were queued and loose polygons on top. Shapes are retained:
+// their triangles are cached together with the shape's version and only re-tessellated when it
+// changed. A frame in which no shape changed, appeared or vanished is not submitted at all, and
+// the Window keeps showing the previous one. The vertex buffers are swapped with the Window
+// rather than copied and keep their capacity, so steady frames do not allocate.
 class RenderEngine{
 public:
   RenderEngine() = default;
-  auto AddToQueue( const Polygon& p ){ polygons_.emplace( p ); }
-  auto AddToQueue( const Shape& s ){ 
-    std::for_each( s.GetPolygons().begin(), s.GetPolygons().end(), [this]( const auto& p ){ AddToQueue(p); } ); 
-  }
-
-  auto Render(){
-    while( !polygons_.empty() ){
-      shapes_.emplace( RenderPolygon(polygons_.front()) );
-      polygons_.pop();
+  // Polygons queued on their own are not cached; they are tessellated again every frame.
+  auto AddToQueue( const Polygon& p ){ Tessellate( p, Transform::Identity(), SelectLod( p, Transform::Identity() ), immediate_ ); }
+  // A shape stays on screen as long as it is queued every frame; a static one costs a lookup.
+  auto AddToQueue( const Shape& s ){
+    auto [it, inserted] = cache_.try_emplace( &s );
+    auto& entry = it->second;
+    auto version = s.GetTreeVersion();
+    auto moved = inserted || entry.version != version;
+    if( moved || entry.pixel_scale != pixel_scale_ ){
+      auto transform = s.GetWorldTransform();
+      lod_.clear();
+      std::for_each( s.GetPolygons().begin(), s.GetPolygons().end(), [this, &transform]( const auto& p ){ lod_.push_back( SelectLod( p, transform ) ); } );
+      // Point sprites have a fixed size on screen, so their world-space size follows every zoom.
+      auto sprites = std::find( lod_.begin(), lod_.end(), CircleMesh::POINT_SPRITE ) != lod_.end();
+      if( moved || lod_ != entry.lod || sprites ){
+        entry.version = version;
+        std::swap( entry.lod, lod_ );
+        entry.vertices.clear();
+        auto lod = entry.lod.begin();
+        std::for_each( s.GetPolygons().begin(), s.GetPolygons().end(), [this, &entry, &transform, &lod]( const auto& p ){ Tessellate( p, transform, *lod++, entry.vertices ); } );
+        changed_ = true;
+      }
+      entry.pixel_scale = pixel_scale_;
     }
+    entry.frame = frame_;
+    order_.push_back( &s );
   }
+  // Pixels per world unit of the current view. Circular polygons are then drawn with as many
+  // segments as their size on screen needs, or as a point sprite when they are smaller than a pixel.
+  // 0, the default, draws every polygon with its own points.
+  auto SetPixelScale( double pixel_scale ) noexcept -> void { pixel_scale_ = pixel_scale; }
   
   auto RegisterWindow(Window& w){
     callback_ = GenerateNotification(w) ;
   }
+  // Renders off screen instead, e.g. on machines without a display.
+  auto RegisterTarget( HeadlessTarget& t ){ callback_ = GenerateNotification(t); }
   
+  // Ends the frame: shapes not queued since the last call are dropped, and the frame is
+  // submitted if anything differs from the previous one.
   auto Notify() {
-    callback_(shapes_);
+    PROFILE_SCOPE( "RenderEngine::Notify" );
+    std::erase_if( cache_, [this]( const auto& pair ){ return pair.second.frame != frame_; } );
+    changed_ = changed_ || order_ != last_order_ || !immediate_.empty() || had_immediate_;
+    had_immediate_ = !immediate_.empty();
+    std::swap( order_, last_order_ );
+    order_.clear();
+    ++frame_;
+    if( !changed_ )
+      return;
+    batch_.clear();
+    for( const auto* shape : last_order_ )
+      Append( cache_[shape].vertices );
+    Append( immediate_ );
+    immediate_.clear();
+    callback_(batch_);
+    changed_ = false;
   }
+  auto GetCachedShapeCount() const noexcept -> size_t { return cache_.size(); }
 
 private:
-  static sf::ConvexShape RenderPolygon( const Polygon& p ){
-    auto points = p.GetPoints();
-    auto convex_shape = sf::ConvexShape( points.size() );
-    for( size_t i=0; i<points.size(); ++i ){
-      convex_shape.setPoint(i, points.at(i).SfVector() );
+  struct CachedShape{
+    uint64_t version{};
+    uint64_t frame{};
+    double pixel_scale{};
+    std::vector<size_t> lod{};
+    std::vector<sf::Vertex> vertices{};
+  };
+  // CircleMesh::Segments of a polygon under the given transform, or CircleMesh::OWN_POINTS.
+  auto SelectLod( const Polygon& p, const Transform& parent ) const noexcept -> size_t {
+    if( p.GetRadius() <= 0 || pixel_scale_ <= 0 )
+      return CircleMesh::OWN_POINTS;
+    auto scale = std::sqrt( std::abs( parent.Determinant() * p.GetTransform().Determinant() ) );
+    return CircleMesh::Segments( p.GetRadius() * scale * pixel_scale_ );
+  }
+  // Polygons are convex. At their own detail they are drawn from the fan their mesh built once,
+  // mapped straight into out; circles at another detail take their points from the shared unit
+  // meshes and are fanned here. This is the only place where local vertices are mapped to the screen.
+  auto Tessellate( const Polygon& p, const Transform& parent, size_t lod, std::vector<sf::Vertex>& out ) -> void {
+    auto color = sf::Color{ p.GetColor().red, p.GetColor().green, p.GetColor().blue };
+    if( lod == CircleMesh::OWN_POINTS ){
+      auto transform = parent * p.GetTransform();
+      for( const auto& q : p.GetMesh()->GetTriangles() )
+        out.emplace_back( transform.Apply(q).SfVector(), color );
+      return;
+    }
+    if( lod == CircleMesh::POINT_SPRITE ){
+      auto center = parent.Apply( p.GetCenterMass() );
+      const auto& sprite = CircleMesh::Sprite();
+      points_.resize( sprite.size() );
+      std::transform( sprite.begin(), sprite.end(), points_.begin(), [this, &center]( const auto& q ){ return center + q * ( CircleMesh::POINT_RADIUS / pixel_scale_ ); } );
+    } else {
+      auto center = p.GetCenterMass();
+      auto radius = p.GetRadius() * std::sqrt( std::abs( p.GetTransform().Determinant() ) );
+      const auto& mesh = CircleMesh::Get( lod );
+      points_.resize( mesh.size() );
+      std::transform( mesh.begin(), mesh.end(), points_.begin(), [&parent, &center, radius]( const auto& q ){ return parent.Apply( center + q * radius ); } );
     }
-    convex_shape.setFillColor( {p.GetColor().red, p.GetColor().green, p.GetColor().blue });
-    return convex_shape;
-  }
-  static std::function<void( std::queue<sf::ConvexShape>& )> GenerateNotification( Window& w ){
-    return 
-      [&w]( std::queue<sf::ConvexShape>& shape_queue ) mutable {
-        while(!shape_queue.empty()){
-          w.AddToQueue(shape_queue.front());
-          shape_queue.pop();
-        }
-      };
-  }
-  std::queue<Polygon> polygons_{};
-  std::queue<sf::ConvexShape> shapes_{};
-  std::function<void( std::queue<sf::ConvexShape>& )> callback_;
+    const auto& points = points_;
+    auto first = sf::Vertex{ points.front().SfVector(), color };
+    for( size_t i=1; i+1<points.size(); ++i ){
+      out.push_back( first );
+      out.emplace_back( points[i].SfVector(), color );
+      out.emplace_back( points[i+1].SfVector(), color );
+    }
+  }
+  auto Append( const std::vector<sf::Vertex>& vertices ) -> void {
+    if( vertices.empty() )
+      return;
+    auto offset = batch_.getVertexCount();
+    batch_.resize( offset + vertices.size() );
+    std::copy( vertices.begin(), vertices.end(), &batch_[offset] );
+  }
+  static std::function<void( sf::VertexArray& )> GenerateNotification( Window& w ){
+    return [&w]( sf::VertexArray& batch ) mutable { w.Submit( batch ); };
+  }
+  static std::function<void( sf::VertexArray& )> GenerateNotification( HeadlessTarget& t ){
+    return [&t]( sf::VertexArray& batch ) mutable { t.Submit( batch ); };
+  }
+  std::unordered_map<const Shape*, CachedShape> cache_{};
+  std::vector<const Shape*> order_{};
+  std::vector<const Shape*> last_order_{};
+  std::vector<sf::Vertex> immediate_{};
+  std::vector<Point2D> points_{};
+  std::vector<size_t> lod_{};
+  double pixel_scale_{0.0};
+  sf::VertexArray batch_{ sf::Triangles };
+  uint64_t frame_{0};
+  bool changed_{false};
+  bool had_immediate_{false};
+  std::function<void( sf::VertexArray& )> callback_;
 };
 
 #endif // RENDER_ENGINE_H
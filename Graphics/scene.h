@@ -2,10 +2,16 @@
 #define SCENE_H
 
 #include <algorithm>
+#include <functional>
 #include <list>
 #include <memory>
 
+#include "bounding_box.h"
+#include "camera.h"
+#include "headless_target.h"
+#include "profiler.h"
 #include "shape.h"
+#include "shape_grid.h"
 #include "render_engine.h"
 #include "window.h"
 
@@ -13,16 +19,42 @@ class Scene{
 public:
   Scene() = default;
   auto RegisterWindow( Window& w ) noexcept -> void { render_engine_.RegisterWindow(w); }
-  auto AddShape( Shape* s ){ shapes_.emplace_back(s); }
-  auto AddShape( std::unique_ptr<Shape>&& s ){ shapes_.emplace_back( std::move(s) ); }
+  auto RegisterTarget( HeadlessTarget& t ) noexcept -> void { render_engine_.RegisterTarget(t); }
+  // With a camera only the shapes whose bounding box reaches into its view are queued, and
+  // circles are drawn at the detail their size under the camera's zoom needs.
+  auto RegisterCamera( Camera& c ) -> void { 
+    view_request_ = GenerateViewRequest(c); 
+    scale_request_ = GenerateScaleRequest(c);
+  }
+  auto SetCellSize( double cell_size ) -> void { grid_.SetCellSize( cell_size ); }
+  auto AddShape( Shape* s ) -> Shape& { return *shapes_.emplace_back(s); }
+  auto AddShape( std::unique_ptr<Shape>&& s ) -> Shape& { return *shapes_.emplace_back( std::move(s) ); }
+  auto RemoveShape( const Shape* s ){
+    grid_.Remove( s );
+    shapes_.remove_if( [s]( const auto& p ){ return p.get() == s; } );
+  }
+  // The RenderEngine caches every shape's triangles, so only shapes moved since the last Update
+  // are tessellated again, and an unchanged scene submits nothing.
   auto Update(){
-    std::for_each( shapes_.begin(), shapes_.end(), [this]( const auto& s ){ render_engine_.AddToQueue( *s ); } );
-    render_engine_.Render();
+    PROFILE_SCOPE( "Scene::Update" );
+    if( !view_request_ ){
+      std::for_each( shapes_.begin(), shapes_.end(), [this]( const auto& s ){ render_engine_.AddToQueue( *s ); } );
+    } else {
+      render_engine_.SetPixelScale( scale_request_() );
+      std::for_each( shapes_.begin(), shapes_.end(), [this]( const auto& s ){ grid_.Update( s.get() ); } );
+      for( const auto* s : grid_.Query( view_request_() ) )
+        render_engine_.AddToQueue( *s );
+    }
     render_engine_.Notify();
   }
 private:
+  auto GenerateViewRequest( Camera& c ) -> std::function<BoundingBox(void)> { return [&c](){ return c.GetViewBox(); }; }
+  auto GenerateScaleRequest( Camera& c ) -> std::function<double(void)> { return [&c](){ return c.GetPixelScale(); }; }
   std::list<std::unique_ptr<Shape>> shapes_{};
+  ShapeGrid grid_{};
+  std::function<BoundingBox(void)> view_request_{};
+  std::function<double(void)> scale_request_{};
   RenderEngine render_engine_;
 };
 
-#endif // SCENE_H
\ No newline at end of file
+#endif // SCENE_H
@@ -2,22 +2,70 @@
 #define SHAPE_H
 
 #include <algorithm>
+#include <atomic>
+#include <cstdint>
 #include <vector>
 
+#include "bounding_box.h"
 #include "coordinates.h"
 #include "polygon.h"
+#include "transform.h"
 
+// A group of polygons under one transform. Polygons keep their vertices in local space; the
+// shape's transform, composed with its parent's, is applied only when the shape is drawn, so
+// moving or rotating a shape is O(1) however many vertices it has.
 class Shape{
 public:
   Shape() = default;
-  auto AddPolygon( Polygon p ) noexcept -> Shape&  { polygons_.push_back( std::move(p) ); CalculateCM(); return *this; }
+  auto AddPolygon( Polygon p ) noexcept -> Shape&  { polygons_.push_back( std::move(p) ); CalculateCM(); Touch(); return *this; }
   const auto& GetPolygons() const noexcept { return polygons_; }
-  auto Translate( const Point2D& point ){ Perform( [&point]( auto& p ){ p.Translate(point); } ); }
-  auto Rotate( const Point2D& point, double angle ){ Perform( [&point, angle]( auto& p ){ p.Rotate(point, angle); } ); }
-  auto RotateCM( double angle ){ Perform( [this, angle]( auto& p ){ p.Rotate(center_mass_, angle); } ); }
+  // Moves the shape so that its center of mass ends up at point.
+  auto Translate( const Point2D& point ){ 
+    auto cm = GetCenterMass();
+    if( cm == point )
+      return;
+    transform_ = Transform::Translation( point - cm ) * transform_;
+    Touch();
+  }
+  auto Rotate( const Point2D& point, double angle ){ transform_ = Transform::Rotation( angle, point ) * transform_; Touch(); }
+  auto RotateCM( double angle ){ Rotate( GetCenterMass(), angle ); }
+  auto SetTransform( const Transform& transform ) noexcept -> Shape& { transform_ = transform; Touch(); return *this; }
+  // The parent's world transform is applied on top of this shape's; the parent must outlive the child.
+  auto SetParent( const Shape* parent ) noexcept -> Shape& { parent_ = parent; Touch(); return *this; }
+  // Edits the polygons themselves, e.g. their own transforms or colors.
   template<typename F>
-  auto Perform( const F& func ) noexcept -> void { std::for_each( polygons_.begin(), polygons_.end(), func ); }
+  auto Perform( const F& func ) noexcept -> void { std::for_each( polygons_.begin(), polygons_.end(), func ); CalculateCM(); Touch(); }
+
+  auto GetTransform() const noexcept -> const Transform& { return transform_; }
+  auto GetWorldTransform() const noexcept -> Transform { return parent_ ? parent_->GetWorldTransform() * transform_ : transform_; }
+  auto GetParent() const noexcept -> const Shape* { return parent_; }
+  // Center of mass in the parent's space, or in world space for a shape without parent.
+  auto GetCenterMass() const noexcept -> Point2D { return transform_.Apply( center_mass_ ); }
+  // World-space bounds, recomputed from the polygons' local boxes when the shape or a parent changed.
+  auto GetBoundingBox() const noexcept -> const BoundingBox& {
+    auto version = GetTreeVersion();
+    if( box_version_ != version ){
+      auto transform = GetWorldTransform();
+      box_ = BoundingBox{};
+      std::for_each( polygons_.begin(), polygons_.end(), [this, &transform]( const auto& p ){ 
+        box_.Expand( p.GetLocalBoundingBox().Transformed( transform * p.GetTransform() ) ); 
+      } );
+      box_version_ = version;
+    }
+    return box_;
+  }
+  // Changes on every modification. Versions are unique across all shapes, so a renderer caching
+  // geometry by version never mistakes a new shape for an old one.
+  auto GetVersion() const noexcept -> uint64_t { return version_; }
+  // Versions only grow, so the largest one along the parent chain changes whenever this shape
+  // or any of its ancestors did.
+  auto GetTreeVersion() const noexcept -> uint64_t { return parent_ ? std::max( version_, parent_->GetTreeVersion() ) : version_; }
 private:
+  static auto NextVersion() noexcept -> uint64_t { 
+    static auto counter = std::atomic<uint64_t>{0};
+    return ++counter;
+  }
+  auto Touch() noexcept -> void { version_ = NextVersion(); }
   auto CalculateCM() -> void { 
     center_mass_.x = 0;
     center_mass_.y = 0;
@@ -26,6 +74,11 @@ private:
   }
   std::vector<Polygon> polygons_{};
   Point2D center_mass_{0.0, 0.0};
+  Transform transform_{};
+  const Shape* parent_{nullptr};
+  uint64_t version_{ NextVersion() };
+  mutable BoundingBox box_{};
+  mutable uint64_t box_version_{0};
 };
 
-#endif // SHAPE_H
\ No newline at end of file
+#endif // SHAPE_H
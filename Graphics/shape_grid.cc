@@ -0,0 +1,108 @@
+#include "shape_grid.h"
+
+#include <algorithm>
+#include <cmath>
+
+auto ShapeGrid::Update( const Shape* shape ) -> void {
+  auto [it, inserted] = entries_.try_emplace( shape );
+  auto& entry = it->second;
+  auto version = shape->GetTreeVersion();
+  if( inserted )
+    entry.order = next_order_++;
+  else if( entry.version == version )
+    return;
+  entry.version = version;
+  entry.box = shape->GetBoundingBox();
+  auto cell = CellOf( entry.box );
+  if( cell == entry.cell )
+    return;
+  Erase( shape, entry.cell );
+  if( cell != NO_CELL )
+    cells_[cell].push_back( shape );
+  entry.cell = cell;
+}
+
+auto ShapeGrid::Remove( const Shape* shape ) -> void {
+  auto it = entries_.find( shape );
+  if( it == entries_.end() )
+    return;
+  Erase( shape, it->second.cell );
+  entries_.erase( it );
+}
+
+auto ShapeGrid::Clear() -> void {
+  entries_.clear();
+  cells_.clear();
+  next_order_ = 0;
+}
+
+auto ShapeGrid::Query( const BoundingBox& view ) -> const std::vector<const Shape*>& {
+  hits_.clear();
+  result_.clear();
+  if( view.IsEmpty() )
+    return result_;
+  auto oversized = cells_.find( OVERSIZED );
+  if( oversized != cells_.end() )
+    Collect( oversized->second, view );
+  auto x0 = Cell( view.min.x - cell_size_ / 2 );
+  auto x1 = Cell( view.max.x + cell_size_ / 2 );
+  auto y0 = Cell( view.min.y - cell_size_ / 2 );
+  auto y1 = Cell( view.max.y + cell_size_ / 2 );
+  // Zoomed far out the view covers more cells than are occupied: walk the buckets instead.
+  if( static_cast<double>( x1 - x0 + 1 ) * static_cast<double>( y1 - y0 + 1 ) > static_cast<double>( cells_.size() ) ){
+    for( const auto& [key, bucket] : cells_ )
+      if( key != OVERSIZED )
+        Collect( bucket, view );
+  } else {
+    for( auto ix = x0; ix <= x1; ++ix ){
+      for( auto iy = y0; iy <= y1; ++iy ){
+        auto cell = cells_.find( Key( ix, iy ) );
+        if( cell != cells_.end() )
+          Collect( cell->second, view );
+      }
+    }
+  }
+  std::sort( hits_.begin(), hits_.end() );
+  for( const auto& hit : hits_ )
+    result_.push_back( hit.second );
+  return result_;
+}
+
+auto ShapeGrid::Cell( double coordinate ) const noexcept -> int64_t {
+  auto cell = std::floor( coordinate / cell_size_ );
+  return static_cast<int64_t>( std::clamp( cell, -double(BIAS), double(BIAS - 2) ) );
+}
+
+auto ShapeGrid::CellOf( const BoundingBox& box ) const noexcept -> uint64_t {
+  if( box.IsEmpty() )
+    return NO_CELL;
+  auto size = box.Size();
+  if( std::max( size.x, size.y ) > cell_size_ )
+    return OVERSIZED;
+  auto center = box.Center();
+  return Key( Cell( center.x ), Cell( center.y ) );
+}
+
+auto ShapeGrid::Erase( const Shape* shape, uint64_t cell ) -> void {
+  if( cell == NO_CELL )
+    return;
+  auto bucket = cells_.find( cell );
+  if( bucket == cells_.end() )
+    return;
+  auto& shapes = bucket->second;
+  auto it = std::find( shapes.begin(), shapes.end(), shape );
+  if( it != shapes.end() ){
+    *it = shapes.back();
+    shapes.pop_back();
+  }
+  if( shapes.empty() )
+    cells_.erase( bucket );
+}
+
+auto ShapeGrid::Collect( const std::vector<const Shape*>& bucket, const BoundingBox& view ) -> void {
+  for( const auto* shape : bucket ){
+    const auto& entry = entries_.find( shape )->second;
+    if( entry.box.Intersects( view ) )
+      hits_.emplace_back( entry.order, shape );
+  }
+}
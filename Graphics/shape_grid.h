@@ -0,0 +1,60 @@
+#ifndef SHAPE_GRID_H
+#define SHAPE_GRID_H
+
+#include <cstdint>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+#include "bounding_box.h"
+#include "shape.h"
+
+// Loose uniform grid over shape bounding boxes. A shape is filed under the cell of its box center,
+// so a query only has to widen the view by half a cell to catch everything that reaches into it.
+// Shapes larger than a cell are kept aside and tested on every query. Update() re-files a shape
+// only if its version changed and only moves it between buckets if its center left its cell.
+class ShapeGrid{
+public:
+  explicit ShapeGrid( double cell_size = 256.0 ) : cell_size_(cell_size) {}
+
+  auto Update( const Shape* shape ) -> void;
+  auto Remove( const Shape* shape ) -> void;
+  auto Clear() -> void;
+  // Shapes whose box intersects view, in the order they were first added; valid until the next call.
+  auto Query( const BoundingBox& view ) -> const std::vector<const Shape*>&;
+  // Drops all shapes and starts over with a new cell size.
+  auto SetCellSize( double cell_size ) -> void { Clear(); cell_size_ = cell_size; }
+
+  auto GetCellSize() const noexcept -> double { return cell_size_; }
+  auto GetCellCount() const noexcept -> size_t { return cells_.size(); }
+  auto Size() const noexcept -> size_t { return entries_.size(); }
+
+private:
+  static constexpr uint64_t NO_CELL = ~uint64_t{0};
+  static constexpr uint64_t OVERSIZED = NO_CELL - 1;
+  static constexpr int64_t BIAS = int64_t{1} << 31;
+  struct Entry{
+    uint64_t version{};
+    uint64_t cell{NO_CELL};
+    uint64_t order{};
+    BoundingBox box{};
+  };
+  // Indices are biased into [0, 2^32) and Cell() keeps them below INT32_MAX, so a real cell never
+  // packs to NO_CELL or OVERSIZED, whose upper halves are all ones.
+  auto Key( int64_t ix, int64_t iy ) const noexcept -> uint64_t {
+    return ( static_cast<uint64_t>( static_cast<uint32_t>( ix + BIAS ) ) << 32 ) | static_cast<uint32_t>( iy + BIAS );
+  }
+  auto Cell( double coordinate ) const noexcept -> int64_t;
+  auto CellOf( const BoundingBox& box ) const noexcept -> uint64_t;
+  auto Erase( const Shape* shape, uint64_t cell ) -> void;
+  auto Collect( const std::vector<const Shape*>& bucket, const BoundingBox& view ) -> void;
+
+  double cell_size_;
+  uint64_t next_order_{0};
+  std::unordered_map<const Shape*, Entry> entries_{};
+  std::unordered_map<uint64_t, std::vector<const Shape*>> cells_{};
+  std::vector<std::pair<uint64_t, const Shape*>> hits_{};
+  std::vector<const Shape*> result_{};
+};
+
+#endif // SHAPE_GRID_H
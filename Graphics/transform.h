@@ -0,0 +1,41 @@
+#ifndef TRANSFORM_H
+#define TRANSFORM_H
+
+#include <cmath>
+
+#include "coordinates.h"
+
+// 2D affine map p -> M p + t. Composition reads right to left like matrices: (a * b)( p ) == a( b( p ) ).
+struct Transform{
+  double m00{1.0}, m01{0.0};
+  double m10{0.0}, m11{1.0};
+  Point2D t{};
+
+  static constexpr auto Identity() noexcept -> Transform { return {}; }
+  static constexpr auto Translation( const Point2D& offset ) noexcept -> Transform { return { 1.0, 0.0, 0.0, 1.0, offset }; }
+  // Rotation by angle (radians, counter-clockwise) around center.
+  static auto Rotation( double angle, const Point2D& center = {} ) noexcept -> Transform {
+    auto c = std::cos( angle );
+    auto s = std::sin( angle );
+    return { c, -s, s, c, center - Point2D{ c*center.x - s*center.y, s*center.x + c*center.y } };
+  }
+
+  constexpr auto Apply( const Point2D& p ) const noexcept -> Point2D { 
+    return { m00*p.x + m01*p.y + t.x, m10*p.x + m11*p.y + t.y }; 
+  }
+  // Factor by which the map scales areas; its square root is the scale of lengths.
+  constexpr auto Determinant() const noexcept -> double { return m00*m11 - m01*m10; }
+  constexpr auto IsIdentity() const noexcept -> bool { 
+    return m00 == 1.0 && m01 == 0.0 && m10 == 0.0 && m11 == 1.0 && t == Point2D{}; 
+  }
+
+  friend constexpr auto operator*( const Transform& a, const Transform& b ) noexcept -> Transform {
+    return {
+      a.m00*b.m00 + a.m01*b.m10, a.m00*b.m01 + a.m01*b.m11,
+      a.m10*b.m00 + a.m11*b.m10, a.m10*b.m01 + a.m11*b.m11,
+      a.Apply( b.t )
+    };
+  }
+};
+
+#endif // TRANSFORM_H
@@ -1,60 +1,90 @@
 #ifndef WINDOW_H
 #define WINDOW_H
 
-#include <SFML/Graphics/ConvexShape.hpp>
 #include <SFML/Graphics/View.hpp>
 #include <algorithm>
 #include <atomic>
 #include <chrono>
+#include <cstdint>
 #include <math.h>
 #include <memory>
-#include <mutex>
-#include <queue>
 #include <thread>
 #include <vector>
 
 #include <SFML/Graphics/Color.hpp>
 #include <SFML/Graphics/RenderWindow.hpp>
+#include <SFML/Graphics/VertexArray.hpp>
 #include <SFML/Window/Event.hpp>
 #include <SFML/Window/Keyboard.hpp>
 #include <SFML/Window/Mouse.hpp>
 #include <SFML/Window/Window.hpp>
 
 #include "coordinates.h"
+#include "profiler.h"
+#include "profiler_overlay.h"
+#include "ring_buffer.h"
+#include "triple_buffer.h"
 
 class Window{
 public:
+  using EventQueue = RingBuffer<sf::Event, 256>;
   Window( double width, double hight ) : 
-    window_{sf::VideoMode(width, hight), "My window" } { }  
+    window_{sf::VideoMode(width, hight), "My window" } { window_.setVerticalSyncEnabled(true); }
   auto Update(){
-    auto lock = std::lock_guard{window_mutex_};
+    PROFILE_SCOPE( "Window::Update" );
+    // Every pending event is handled each frame; all but Closed go to the event queue.
     auto event = sf::Event();
-    if( window_.pollEvent(event) ){
+    while( window_.pollEvent(event) ){
       if( event.type == sf::Event::Closed ){
         exit_ = true;
         return;
       }
+      if( !events_.Push( event ) )
+        lost_events_.fetch_add( 1, std::memory_order_relaxed );
     }
+    if( !frames_.HasUpdate() )
+      repeated_.fetch_add( 1, std::memory_order_relaxed );
     window_.clear(sf::Color::White);
-    while( !draw_queue_.empty() ){
-      window_.draw(draw_queue_.front() );
-      draw_queue_.pop();
-    }
+    window_.draw( frames_.Read() );
+    if( show_profiler_ )
+      overlay_.Draw( window_ );
     window_.display();
   }
-  auto Exit(){ return exit_; }
-  auto AddToQueue( sf::ConvexShape shape ){ 
-    auto lock = std::lock_guard{window_mutex_}; 
-    draw_queue_.emplace(std::move(shape)); 
+  auto Exit() -> bool { return exit_; }
+  // Takes the frame by swapping buffers with the caller, who gets an old frame back to refill.
+  // Submit and Update never wait for each other: a frame submitted before Update picked up the
+  // previous one replaces it, and until the next Submit, Update keeps drawing the last frame.
+  // One thread may Submit while another runs Update.
+  auto Submit( sf::VertexArray& frame ){
+    std::swap( frames_.GetWriteBuffer(), frame );
+    if( !frames_.Publish() )
+      dropped_.fetch_add( 1, std::memory_order_relaxed );
   }
+  // Frames replaced by a newer one before they were drawn.
+  auto GetDroppedFrames() const noexcept -> uint64_t { return dropped_.load( std::memory_order_relaxed ); }
+  // Updates that redrew the previous frame because nothing new was submitted. RenderEngine submits
+  // nothing while the scene is unchanged, so these are not missed frames: a static scene counts
+  // every Update here.
+  auto GetRepeatedFrames() const noexcept -> uint64_t { return repeated_.load( std::memory_order_relaxed ); }
+  // Window events for one consumer, e.g. Mouse, which may run on another thread than Update.
+  auto GetEvents() noexcept -> EventQueue& { return events_; }
+  // Events refused because the consumer fell a whole queue behind.
+  auto GetLostEvents() const noexcept -> uint64_t { return lost_events_.load( std::memory_order_relaxed ); }
+  // Draws the profiler's stage timings over the frame; needs a build with ENABLE_PROFILER.
+  auto ShowProfiler( bool show ) noexcept -> void { show_profiler_ = show; }
   auto SetView( const sf::View& view_point ){ window_.setView(view_point); }
   auto operator*() -> sf::RenderWindow& { return window_; }
 
 private:
-  std::mutex window_mutex_{};
-  bool exit_{false};
+  std::atomic<bool> exit_{false};
+  std::atomic<uint64_t> dropped_{0};
+  std::atomic<uint64_t> repeated_{0};
+  std::atomic<uint64_t> lost_events_{0};
   sf::RenderWindow window_;
-  std::queue<sf::ConvexShape> draw_queue_{};
+  TripleBuffer<sf::VertexArray> frames_{ sf::VertexArray{ sf::Triangles } };
+  EventQueue events_{};
+  ProfilerOverlay overlay_{};
+  bool show_profiler_{false};
   std::function<void(void)> camera_notification_{};
 };
 
@@ -0,0 +1,70 @@
+#include "body_storage.h"
+
+#include <algorithm>
+#include <utility>
+
+auto BodyStorage::Add( const Body& body ) -> size_t {
+  x.push_back( body.GetPosition().x );
+  y.push_back( body.GetPosition().y );
+  vx.push_back( body.GetVelocity().x );
+  vy.push_back( body.GetVelocity().y );
+  ax.push_back( 0.0 );
+  ay.push_back( 0.0 );
+  mass.push_back( body.GetMass() );
+  radius.push_back( body.GetRadius() );
+  id.push_back( index_of_.size() );
+  index_of_.push_back( x.size() - 1 );
+  return x.size() - 1;
+}
+
+auto BodyStorage::Remove( size_t index ) -> void {
+  auto last = Size() - 1;
+  index_of_[ id[index] ] = NPOS;
+  if( index != last ){
+    x[index] = x[last];
+    y[index] = y[last];
+    vx[index] = vx[last];
+    vy[index] = vy[last];
+    ax[index] = ax[last];
+    ay[index] = ay[last];
+    mass[index] = mass[last];
+    radius[index] = radius[last];
+    id[index] = id[last];
+    index_of_[ id[index] ] = index;
+  }
+  for( auto* v : { &x, &y, &vx, &vy, &ax, &ay, &mass, &radius } )
+    v->pop_back();
+  id.pop_back();
+}
+
+auto BodyStorage::Reserve( size_t n ) -> void {
+  for( auto* v : { &x, &y, &vx, &vy, &ax, &ay, &mass, &radius } )
+    v->reserve( n );
+  id.reserve( n );
+}
+
+auto BodyStorage::Resize( size_t n ) -> void {
+  for( auto* v : { &x, &y, &vx, &vy, &ax, &ay, &mass, &radius } )
+    v->resize( n );
+  for( auto i = id.size(); i < n; ++i ){
+    id.push_back( index_of_.size() );
+    index_of_.push_back( i );
+  }
+  for( auto i = n; i < id.size(); ++i )
+    index_of_[ id[i] ] = NPOS;
+  id.resize( n );
+}
+
+auto BodyStorage::Clear() noexcept -> void {
+  for( auto* v : { &x, &y, &vx, &vy, &ax, &ay, &mass, &radius } )
+    v->clear();
+  id.clear();
+  index_of_.clear();
+}
+
+auto BodyStorage::RebuildIndex( size_t next_id ) -> void {
+  auto n_ids = id.empty() ? next_id : std::max( next_id, *std::max_element( id.begin(), id.end() ) + 1 );
+  index_of_.assign( n_ids, NPOS );
+  for( size_t i=0; i<id.size(); ++i )
+    index_of_[ id[i] ] = i;
+}
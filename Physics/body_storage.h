@@ -0,0 +1,96 @@
+#ifndef BODY_STORAGE_H
+#define BODY_STORAGE_H
+
+#include <compare>
+#include <limits>
+#include <vector>
+
+#include "body.h"
+#include "coordinates.h"
+
+// Bodies are addressed by index inside the force loops and by a stable id from the outside:
+// Remove() swaps the last body into the freed slot, so indices move while ids never do.
+struct BodyStorage{
+  static constexpr size_t NPOS = std::numeric_limits<size_t>::max();
+
+  std::vector<double> x{};
+  std::vector<double> y{};
+  std::vector<double> vx{};
+  std::vector<double> vy{};
+  std::vector<double> ax{};
+  std::vector<double> ay{};
+  std::vector<double> mass{};
+  std::vector<double> radius{};
+  std::vector<size_t> id{};
+
+  BodyStorage() = default;
+  // Test particles number their ids independently of the bodies, so the storage remembers which it holds.
+  explicit BodyStorage( bool particles ) : particles_(particles) {}
+
+  auto HoldsParticles() const noexcept -> bool { return particles_; }
+  // Set when a BodyHandle changed a mass, position or velocity; the owning World clears it once the
+  // accelerations are recomputed, and until then treats its stored accelerations as stale.
+  auto MarkEdited() noexcept -> void { edited_ = true; }
+  auto ClearEdited() noexcept -> void { edited_ = false; }
+  auto Edited() const noexcept -> bool { return edited_; }
+  auto Size() const noexcept -> size_t { return x.size(); }
+  auto Empty() const noexcept -> bool { return x.empty(); }
+  auto IndexOf( size_t body_id ) const noexcept -> size_t { return body_id < index_of_.size() ? index_of_[body_id] : NPOS; }
+  // Id the next added body gets; ids of removed bodies are never handed out again.
+  auto NextId() const noexcept -> size_t { return index_of_.size(); }
+  auto Add( const Body& body ) -> size_t;
+  auto Remove( size_t index ) -> void;
+  auto Reserve( size_t n ) -> void;
+  auto Resize( size_t n ) -> void;
+  auto Clear() noexcept -> void;
+  // Recreates the id lookup after the id column was filled in bulk, e.g. from a checkpoint.
+  // next_id restores NextId(); it is raised to above the largest id present if needed.
+  auto RebuildIndex( size_t next_id = 0 ) -> void;
+
+private:
+  std::vector<size_t> index_of_{};
+  bool particles_{false};
+  bool edited_{false};
+};
+
+class BodyHandle{
+public:
+  BodyHandle() = default;
+  BodyHandle( BodyStorage* storage, size_t id ) : storage_(storage), id_(id) {}
+
+  auto SetMass( double mass ) noexcept -> BodyHandle& { storage_->mass[Index()] = mass; storage_->MarkEdited(); return *this; }
+  auto SetRadius( double radius ) noexcept -> BodyHandle& { storage_->radius[Index()] = radius; return *this; }
+  auto SetPosition( Point2D pos ) noexcept -> BodyHandle& {
+    auto i = Index();
+    storage_->x[i] = pos.x;
+    storage_->y[i] = pos.y;
+    storage_->MarkEdited();
+    return *this;
+  }
+  auto SetVelocity( Point2D vel ) noexcept -> BodyHandle& {
+    auto i = Index();
+    storage_->vx[i] = vel.x;
+    storage_->vy[i] = vel.y;
+    storage_->MarkEdited();
+    return *this;
+  }
+
+  auto GetPosition() const noexcept -> Point2D { auto i = Index(); return { storage_->x[i], storage_->y[i] }; }
+  auto GetVelocity() const noexcept -> Point2D { auto i = Index(); return { storage_->vx[i], storage_->vy[i] }; }
+  auto GetMass() const noexcept -> double { return storage_->mass[Index()]; }
+  auto GetRadius() const noexcept -> double { return storage_->radius[Index()]; }
+  auto GetIndex() const noexcept -> size_t { return Index(); }
+  auto GetId() const noexcept -> size_t { return id_; }
+  auto IsParticle() const noexcept -> bool { return storage_ && storage_->HoldsParticles(); }
+  // False once the body was removed from its World, e.g. merged away in a collision.
+  auto IsValid() const noexcept -> bool { return storage_ && storage_->IndexOf(id_) != BodyStorage::NPOS; }
+
+  auto operator<=>( const BodyHandle& other ) const noexcept = default;
+
+private:
+  auto Index() const noexcept -> size_t { return storage_->IndexOf(id_); }
+  BodyStorage* storage_{nullptr};
+  size_t id_{};
+};
+
+#endif // BODY_STORAGE_H
@@ -0,0 +1,61 @@
+#include "checkpoint.h"
+
+#include <algorithm>
+#include <cstdint>
+#include <stdexcept>
+
+namespace Checkpoint{
+
+auto Open( const std::string& path, const char* mode ) -> File {
+  auto file = File{ std::fopen( path.c_str(), mode ), &std::fclose };
+  if( !file )
+    throw std::runtime_error( "Checkpoint: cannot open " + path );
+  return file;
+}
+
+auto Write( std::FILE* file, const void* data, size_t size ) -> void {
+  if( size > 0 && std::fwrite( data, 1, size, file ) != size )
+    throw std::runtime_error( "Checkpoint: write failed" );
+}
+
+auto Read( std::FILE* file, void* data, size_t size ) -> void {
+  if( size > 0 && std::fread( data, 1, size, file ) != size )
+    throw std::runtime_error( "Checkpoint: unexpected end of file" );
+}
+
+auto Remaining( std::FILE* file ) -> uint64_t {
+  auto position = std::ftell( file );
+  if( position < 0 || std::fseek( file, 0, SEEK_END ) != 0 )
+    throw std::runtime_error( "Checkpoint: file is not seekable" );
+  auto end = std::ftell( file );
+  if( end < position || std::fseek( file, position, SEEK_SET ) != 0 )
+    throw std::runtime_error( "Checkpoint: file is not seekable" );
+  return static_cast<uint64_t>( end - position );
+}
+
+auto WriteStorage( std::FILE* file, const BodyStorage& storage ) -> void {
+  for( const auto* column : { &storage.x, &storage.y, &storage.vx, &storage.vy, &storage.ax, &storage.ay, &storage.mass, &storage.radius } )
+    Write( file, column->data(), column->size() * sizeof(double) );
+  Write( file, storage.id.data(), storage.id.size() * sizeof(size_t) );
+}
+
+auto ReadStorage( std::FILE* file, BodyStorage& storage, size_t n, size_t next_id ) -> void {
+  constexpr auto ROW_SIZE = 8 * sizeof(double) + sizeof(size_t);
+  // Ids index a lookup table of next_id entries; anything near 2^32 would need tens of GB for it.
+  constexpr auto MAX_ID = size_t{ UINT32_MAX };
+  if( n > Remaining( file ) / ROW_SIZE || next_id > MAX_ID || n > next_id )
+    throw std::runtime_error( "Checkpoint: body count or id range is corrupt" );
+  storage.Clear();
+  storage.Resize( n );
+  for( auto* column : { &storage.x, &storage.y, &storage.vx, &storage.vy, &storage.ax, &storage.ay, &storage.mass, &storage.radius } )
+    Read( file, column->data(), n * sizeof(double) );
+  Read( file, storage.id.data(), n * sizeof(size_t) );
+  if( std::any_of( storage.id.begin(), storage.id.end(), [next_id]( size_t id ){ return id >= next_id; } ) )
+    throw std::runtime_error( "Checkpoint: body id out of range" );
+  storage.RebuildIndex( next_id );
+  for( size_t i=0; i<n; ++i )
+    if( storage.IndexOf( storage.id[i] ) != i )
+      throw std::runtime_error( "Checkpoint: duplicate body id" );
+}
+
+}
@@ -0,0 +1,54 @@
+#ifndef CHECKPOINT_H
+#define CHECKPOINT_H
+
+#include <cstdint>
+#include <cstdio>
+#include <memory>
+#include <string>
+
+#include "body_storage.h"
+
+// World snapshot, native endianness:
+//   CheckpointHeader | integrator state | body columns | particle columns
+// Every column (x, y, vx, vy, ax, ay, mass, radius, id) is stored contiguously, so loading is
+// one read per column straight into the resized storage.
+struct CheckpointHeader{
+  static constexpr char MAGIC[8] = { 'G', 'W', 'O', 'R', 'L', 'D', '\0', '\0' };
+  static constexpr uint32_t VERSION = 2;
+  char magic[8]{};
+  uint32_t version{VERSION};
+  uint32_t solver{};
+  char integrator[32]{};
+  uint64_t n_bodies{};
+  uint64_t n_particles{};
+  uint64_t steps{};
+  double time{};
+  double opening_angle{};
+  uint32_t accelerations_valid{};
+  uint32_t collisions{};
+  uint64_t integrator_state_size{};
+  double softening{};
+  // BodyStorage::NextId() of bodies and particles.
+  uint64_t next_body_id{};
+  uint64_t next_particle_id{};
+  uint32_t precision{};
+  uint32_t reserved{};
+};
+
+namespace Checkpoint{
+
+using File = std::unique_ptr<std::FILE, int(*)(std::FILE*)>;
+
+auto Open( const std::string& path, const char* mode ) -> File;
+auto Write( std::FILE* file, const void* data, size_t size ) -> void;
+auto Read( std::FILE* file, void* data, size_t size ) -> void;
+// Bytes between the current position and the end of the file.
+auto Remaining( std::FILE* file ) -> uint64_t;
+auto WriteStorage( std::FILE* file, const BodyStorage& storage ) -> void;
+// Checks n against the bytes left in the file before allocating, and rejects duplicate ids or ids
+// not below next_id, so a corrupt file throws std::runtime_error instead of exhausting memory.
+auto ReadStorage( std::FILE* file, BodyStorage& storage, size_t n, size_t next_id ) -> void;
+
+}
+
+#endif // CHECKPOINT_H
@@ -0,0 +1,90 @@
+#include "collision.h"
+
+#include <algorithm>
+#include <cmath>
+
+auto CollisionDetector::FindCollisions( const BodyStorage& bodies ) -> const std::vector<Pair>& {
+  pairs_.clear();
+  Update( bodies );
+  if( cell_size_ <= 0 )
+    return pairs_;
+  for( size_t i=0; i<bodies.Size(); ++i ){
+    auto ix = Cell( bodies.x[i] );
+    auto iy = Cell( bodies.y[i] );
+    for( auto dx = -1; dx <= 1; ++dx ){
+      for( auto dy = -1; dy <= 1; ++dy ){
+        auto cell = cells_.find( Key( ix+dx, iy+dy ) );
+        if( cell == cells_.end() )
+          continue;
+        for( auto other_id : cell->second ){
+          auto j = bodies.IndexOf( other_id );
+          if( j <= i )
+            continue;
+          auto rx = bodies.x[j] - bodies.x[i];
+          auto ry = bodies.y[j] - bodies.y[i];
+          auto reach = bodies.radius[i] + bodies.radius[j];
+          if( rx*rx + ry*ry < reach*reach )
+            pairs_.emplace_back( bodies.id[i], other_id );
+        }
+      }
+    }
+  }
+  return pairs_;
+}
+
+auto CollisionDetector::Remove( size_t id ) -> void {
+  if( id < cell_of_.size() )
+    Erase( id );
+}
+
+auto CollisionDetector::Clear() -> void {
+  cells_.clear();
+  cell_of_.clear();
+  cell_size_ = 0.0;
+}
+
+auto CollisionDetector::Update( const BodyStorage& bodies ) -> void {
+  auto max_radius = bodies.Empty() ? 0.0 : *std::max_element( bodies.radius.begin(), bodies.radius.end() );
+  if( 2 * max_radius > cell_size_ ){
+    // Bodies grew past the grid resolution (e.g. after merging): start over with a coarser grid.
+    Clear();
+    cell_size_ = 2 * max_radius;
+  }
+  if( cell_size_ <= 0 )
+    return;
+  for( size_t i=0; i<bodies.Size(); ++i ){
+    auto id = bodies.id[i];
+    if( id >= cell_of_.size() )
+      cell_of_.resize( id + 1, NO_CELL );
+    auto key = Key( Cell( bodies.x[i] ), Cell( bodies.y[i] ) );
+    if( key == cell_of_[id] )
+      continue;
+    Erase( id );
+    cells_[key].push_back( id );
+    cell_of_[id] = key;
+  }
+}
+
+auto CollisionDetector::Cell( double coordinate ) const noexcept -> int64_t {
+  auto cell = std::floor( coordinate / cell_size_ );
+  return static_cast<int64_t>( std::clamp( cell, -double(BIAS), double(BIAS - 2) ) );
+}
+
+auto CollisionDetector::Erase( size_t id ) -> void {
+  auto key = cell_of_[id];
+  if( key == NO_CELL )
+    return;
+  cell_of_[id] = NO_CELL;
+  auto cell = cells_.find( key );
+  if( cell == cells_.end() )
+    return;
+  auto& bucket = cell->second;
+  auto it = std::find( bucket.begin(), bucket.end(), id );
+  if( it != bucket.end() ){
+    *it = bucket.back();
+    bucket.pop_back();
+  }
+  // Dropping empty buckets keeps the map as large as the occupied region, not every cell ever visited.
+  if( bucket.empty() )
+    cells_.erase( cell );
+}
@@ -0,0 +1,45 @@
+#ifndef COLLISION_H
+#define COLLISION_H
+
+#include <cstdint>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+#include "body_storage.h"
+
+// Uniform-grid broad phase over body centers. The cell size is kept at least one body diameter, so
+// touching bodies always sit in neighbouring cells. The grid is updated incrementally: each step
+// only bodies that crossed a cell boundary are moved between buckets.
+class CollisionDetector{
+public:
+  using Pair = std::pair<size_t, size_t>;
+  CollisionDetector() = default;
+
+  // Overlapping pairs as body ids; valid until the next call.
+  auto FindCollisions( const BodyStorage& bodies ) -> const std::vector<Pair>&;
+  auto Remove( size_t id ) -> void;
+  auto Clear() -> void;
+
+  auto GetCellSize() const noexcept -> double { return cell_size_; }
+  auto GetCellCount() const noexcept -> size_t { return cells_.size(); }
+
+private:
+  static constexpr uint64_t NO_CELL = ~uint64_t{0};
+  static constexpr int64_t BIAS = int64_t{1} << 31;
+  auto Update( const BodyStorage& bodies ) -> void;
+  // Indices are biased into [0, 2^32) and Cell() keeps them below INT32_MAX, so no cell packs to
+  // NO_CELL, including (-1,-1) just below the origin.
+  auto Key( int64_t ix, int64_t iy ) const noexcept -> uint64_t {
+    return ( static_cast<uint64_t>( static_cast<uint32_t>( ix + BIAS ) ) << 32 ) | static_cast<uint32_t>( iy + BIAS );
+  }
+  auto Cell( double coordinate ) const noexcept -> int64_t;
+  auto Erase( size_t id ) -> void;
+
+  double cell_size_{0.0};
+  std::unordered_map<uint64_t, std::vector<size_t>> cells_{};
+  std::vector<uint64_t> cell_of_{};
+  std::vector<Pair> pairs_{};
+};
+
+#endif // COLLISION_H
@@ -0,0 +1,38 @@
+#include "collision.h"
+
+#include <cstdio>
+
+// Checks that the collision grid finds an overlapping pair in every quadrant, including the cells
+// just below the origin whose packed keys are most likely to collide with a sentinel. Each pair is
+// checked with a fresh grid and with one the bodies moved into.
+
+namespace {
+
+auto Place( BodyStorage& bodies, Point2D a, Point2D b ) -> void {
+  bodies.x = { a.x, b.x };
+  bodies.y = { a.y, b.y };
+}
+
+}
+
+auto main() -> int {
+  constexpr Point2D OFFSET{ 0.7, 0.0 };
+  auto moving = BodyStorage{};
+  moving.Add( Body{ 1.0, 1.0 } );
+  moving.Add( Body{ 1.0, 1.0 } );
+  auto moved = CollisionDetector{};
+  auto ok = true;
+  for( auto origin : { Point2D{ 0.5, 0.5 }, Point2D{ -1.5, -1.5 }, Point2D{ -0.5, 0.5 }, Point2D{ 0.5, -1.5 },
+                       Point2D{ -2.5, -3.5 }, Point2D{ -1.5, -1.5 } } ){
+    auto fresh = BodyStorage{ moving };
+    Place( fresh, origin, origin + OFFSET );
+    auto fresh_pairs = CollisionDetector{}.FindCollisions( fresh ).size();
+    Place( moving, origin, origin + OFFSET );
+    auto moved_pairs = moved.FindCollisions( moving ).size();
+    auto pass = fresh_pairs == 1 && moved_pairs == 1;
+    std::printf( "(%5.2f, %5.2f)  fresh %zu  moved %zu  %s\n", origin.x, origin.y, fresh_pairs, moved_pairs,
+                 pass ? "ok" : "FAILED" );
+    ok = ok && pass;
+  }
+  return ok ? 0 : 1;
+}
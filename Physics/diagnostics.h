@@ -0,0 +1,47 @@
+#ifndef DIAGNOSTICS_H
+#define DIAGNOSTICS_H
+
+#include <cmath>
+#include <span>
+
+#include "body_storage.h"
+#include "coordinates.h"
+
+// Conserved quantities of the massive bodies at one step. Angular momentum is taken about the
+// origin; particles carry no mass and do not contribute.
+struct WorldDiagnostics{
+  double time{};
+  size_t steps{};
+  double mass{};
+  double kinetic_energy{};
+  double potential_energy{};
+  Point2D momentum{};
+  double angular_momentum{};
+  // Sum of m|r x v|. Relative angular momentum drift is taken against this, since the net angular
+  // momentum of a system without overall rotation is close to zero.
+  double angular_momentum_scale{};
+  Point2D center_of_mass{};
+
+  auto TotalEnergy() const noexcept -> double { return kinetic_energy + potential_energy; }
+
+  // One O(N) pass over the bodies; potential[i] is the potential at body i.
+  static auto Measure( const BodyStorage& b, std::span<const double> potential ) noexcept -> WorldDiagnostics {
+    auto d = WorldDiagnostics{};
+    auto weighted = Point2D{};
+    for( size_t i=0; i<b.Size(); ++i ){
+      auto m = b.mass[i];
+      d.mass += m;
+      d.kinetic_energy += 0.5 * m * ( b.vx[i]*b.vx[i] + b.vy[i]*b.vy[i] );
+      d.potential_energy += 0.5 * m * potential[i];
+      d.momentum += Point2D{ b.vx[i], b.vy[i] } * m;
+      auto l = m * ( b.x[i]*b.vy[i] - b.y[i]*b.vx[i] );
+      d.angular_momentum += l;
+      d.angular_momentum_scale += std::abs( l );
+      weighted += Point2D{ b.x[i], b.y[i] } * m;
+    }
+    d.center_of_mass = d.mass > 0 ? weighted / d.mass : Point2D{};
+    return d;
+  }
+};
+
+#endif // DIAGNOSTICS_H
@@ -1 +1,155 @@
-#include "gravitation.h"
\ No newline at end of file
+#include "gravitation.h"
+
+#include <cmath>
+
+namespace {
+
+// The potential sum shares the distance computation with the force, so it costs one extra
+// accumulator per target; it is compiled in only when the caller asks for it.
+template<bool POTENTIAL>
+auto AccelerateDouble( const BodyStorage& sources, BodyStorage& targets, size_t begin, size_t end,
+                       double softening2, double* potential ) noexcept -> void {
+  const auto n = sources.Size();
+  const auto* __restrict sx = sources.x.data();
+  const auto* __restrict sy = sources.y.data();
+  const auto* __restrict sm = sources.mass.data();
+  for( auto i=begin; i<end; ++i ){
+    const auto xi = targets.x[i];
+    const auto yi = targets.y[i];
+    auto ax = 0.0;
+    auto ay = 0.0;
+    auto phi = 0.0;
+#pragma omp simd reduction(+:ax, ay, phi)
+    for( size_t j=0; j<n; ++j ){
+      auto dx = sx[j] - xi;
+      auto dy = sy[j] - yi;
+      auto r2 = dx*dx + dy*dy;
+      auto self = r2 < std::numeric_limits<double>::min();
+      auto inv_r = self ? 0.0 : 1.0 / std::sqrt( r2 + softening2 );
+      auto w = Gravitation::G * sm[j] * inv_r * inv_r * inv_r;
+      ax += w*dx;
+      ay += w*dy;
+      if constexpr( POTENTIAL )
+        phi += sm[j] * inv_r;
+    }
+    targets.ax[i] = ax;
+    targets.ay[i] = ay;
+    if constexpr( POTENTIAL )
+      potential[i] = -Gravitation::G * phi;
+  }
+}
+
+template<bool POTENTIAL>
+auto AccelerateMixed( const OffsetPoints<float>& sources, std::span<const float> masses, BodyStorage& targets,
+                      size_t begin, size_t end, double softening2, double* potential ) noexcept -> void {
+  const auto n = sources.Size();
+  const auto* __restrict sx = sources.x.data();
+  const auto* __restrict sy = sources.y.data();
+  const auto* __restrict sm = masses.data();
+  const auto eps2 = static_cast<float>( softening2 );
+  const auto g = static_cast<float>( Gravitation::G );
+  for( auto i=begin; i<end; ++i ){
+    const auto offset = sources.Offset( { targets.x[i], targets.y[i] } );
+    auto ax = 0.0f;
+    auto ay = 0.0f;
+    auto phi = 0.0f;
+#pragma omp simd reduction(+:ax, ay, phi)
+    for( size_t j=0; j<n; ++j ){
+      auto dx = sx[j] - offset.x;
+      auto dy = sy[j] - offset.y;
+      auto r2 = dx*dx + dy*dy;
+      auto self = r2 < std::numeric_limits<float>::min();
+      auto inv_r = self ? 0.0f : 1.0f / std::sqrt( r2 + eps2 );
+      auto w = g * sm[j] * inv_r * inv_r * inv_r;
+      ax += w*dx;
+      ay += w*dy;
+      if constexpr( POTENTIAL )
+        phi += sm[j] * inv_r;
+    }
+    targets.ax[i] = ax;
+    targets.ay[i] = ay;
+    if constexpr( POTENTIAL )
+      potential[i] = -Gravitation::G * phi;
+  }
+}
+
+}
+
+auto Gravitation::Accelerate( const BodyStorage& sources, BodyStorage& targets, size_t begin, size_t end,
+                              double softening2, double* potential ) noexcept -> void {
+  if( potential )
+    AccelerateDouble<true>( sources, targets, begin, end, softening2, potential );
+  else
+    AccelerateDouble<false>( sources, targets, begin, end, softening2, nullptr );
+}
+
+auto Gravitation::Accelerate( const OffsetPoints<float>& sources, std::span<const float> masses, BodyStorage& targets,
+                              size_t begin, size_t end, double softening2, double* potential ) noexcept -> void {
+  if( potential )
+    AccelerateMixed<true>( sources, masses, targets, begin, end, softening2, potential );
+  else
+    AccelerateMixed<false>( sources, masses, targets, begin, end, softening2, nullptr );
+}
+
+auto Gravitation::Potential( const BodyStorage& sources, const BodyStorage& targets, size_t begin, size_t end,
+                             double* potential, double softening2 ) noexcept -> void {
+  const auto n = sources.Size();
+  const auto* __restrict sx = sources.x.data();
+  const auto* __restrict sy = sources.y.data();
+  const auto* __restrict sm = sources.mass.data();
+  for( auto i=begin; i<end; ++i ){
+    const auto xi = targets.x[i];
+    const auto yi = targets.y[i];
+    auto phi = 0.0;
+#pragma omp simd reduction(+:phi)
+    for( size_t j=0; j<n; ++j ){
+      auto dx = sx[j] - xi;
+      auto dy = sy[j] - yi;
+      auto r2 = dx*dx + dy*dy;
+      auto self = r2 < std::numeric_limits<double>::min();
+      phi += self ? 0.0 : sm[j] / std::sqrt( r2 + softening2 );
+    }
+    potential[i] = -G * phi;
+  }
+}
+
+auto Gravitation::AccelerateJerk( const BodyStorage& sources, BodyStorage& targets, std::span<const size_t> active,
+                                  double* jx, double* jy, double softening2 ) noexcept -> void {
+  const auto n = sources.Size();
+  const auto* __restrict sx = sources.x.data();
+  const auto* __restrict sy = sources.y.data();
+  const auto* __restrict svx = sources.vx.data();
+  const auto* __restrict svy = sources.vy.data();
+  const auto* __restrict sm = sources.mass.data();
+  for( auto i : active ){
+    const auto xi = targets.x[i];
+    const auto yi = targets.y[i];
+    const auto vxi = targets.vx[i];
+    const auto vyi = targets.vy[i];
+    auto ax = 0.0;
+    auto ay = 0.0;
+    auto jerk_x = 0.0;
+    auto jerk_y = 0.0;
+#pragma omp simd reduction(+:ax, ay, jerk_x, jerk_y)
+    for( size_t j=0; j<n; ++j ){
+      auto dx = sx[j] - xi;
+      auto dy = sy[j] - yi;
+      auto dvx = svx[j] - vxi;
+      auto dvy = svy[j] - vyi;
+      auto r2 = dx*dx + dy*dy;
+      auto self = r2 < std::numeric_limits<double>::min();
+      auto inv_r2 = 1.0 / ( self ? 1.0 : r2 + softening2 );
+      auto inv_r = std::sqrt( inv_r2 );
+      auto w = self ? 0.0 : G * sm[j] * inv_r * inv_r2;
+      auto rv = 3.0 * ( dx*dvx + dy*dvy ) * inv_r2;
+      ax += w*dx;
+      ay += w*dy;
+      jerk_x += w * ( dvx - rv*dx );
+      jerk_y += w * ( dvy - rv*dy );
+    }
+    targets.ax[i] = ax;
+    targets.ay[i] = ay;
+    jx[i] = jerk_x;
+    jy[i] = jerk_y;
+  }
+}
@@ -2,49 +2,43 @@
 #define GRAVITATION_H
 
 #include "body.h"
+#include "body_storage.h"
 #include "coordinates.h"
 #include <limits>
-#include <memory>
+#include <span>
 
 class Gravitation{
 public:
   static constexpr double G = 6371 * 6371; 
-  static auto MoveBody( const double dt, Body* body, const std::vector< std::unique_ptr<Body> >& attractors ) -> void{
-    std::for_each( attractors.begin(), attractors.end(), [dt, body]( const auto& a ) mutable { 
-      if( a.get() == body )
-        return;
-      MoveBody(dt, body, a.get()); 
-    } );
-  }
-  static auto MoveBody( const double dt, Body* body, Body* attractor ) -> void {
-    auto distance = Distance( body->GetPosition(), attractor->GetPosition() );
-    if( distance < std::numeric_limits<double>::min() )
-      return;
-    auto attraction_force = AttractionAcceleration(body, attractor);
-    auto dv = attraction_force*dt;
-    auto vn = body->GetVelocity();
-    auto vnp1 = vn + dv;
-    body->SetVelocity( vnp1 );
-    auto xn = body->GetPosition();
-    auto dx = vnp1 * dt;
-    auto xnp1 = xn + dx;
-    body->SetPosition(xnp1);
-  }
-// private:
+
+  // Fills targets.ax/ay for [begin, end) with the attraction of every body in sources, using
+  // Plummer softening 1/(r^2 + softening2). sources and targets may be the same storage;
+  // coincident pairs are skipped. If potential is given, potential[i] receives the
+  // gravitational potential at target i from the same pass.
+  static auto Accelerate( const BodyStorage& sources, BodyStorage& targets, size_t begin, size_t end,
+                          double softening2 = 0.0, double* potential = nullptr ) noexcept -> void;
+  // Mixed precision variant of Accelerate: sources are float offsets from a double origin, the
+  // pair loop runs in float with twice the SIMD width, results are stored as double.
+  static auto Accelerate( const OffsetPoints<float>& sources, std::span<const float> masses, BodyStorage& targets,
+                          size_t begin, size_t end, double softening2 = 0.0, double* potential = nullptr ) noexcept -> void;
+  // Only the potential part of Accelerate, for integrators whose force pass does not produce it.
+  static auto Potential( const BodyStorage& sources, const BodyStorage& targets, size_t begin, size_t end,
+                         double* potential, double softening2 = 0.0 ) noexcept -> void;
+  // Same as Accelerate for the listed targets only, additionally writing the jerk da/dt to jx/jy.
+  static auto AccelerateJerk( const BodyStorage& sources, BodyStorage& targets, std::span<const size_t> active,
+                              double* jx, double* jy, double softening2 = 0.0 ) noexcept -> void;
+
   static auto AttractionMag(Body* body, Body* attractor) noexcept -> double {
-    auto pos1 = body->GetPosition();
-    auto pos2 = attractor->GetPosition();
-    auto mass = attractor->GetMass();
-    auto d = Distance( pos1, pos2 );
-    auto force = G * mass / d / d;
-    return force;
+    auto d = Distance( body->GetPosition(), attractor->GetPosition() );
+    return G * attractor->GetMass() / d / d;
   }
   static auto AttractionAcceleration( Body* body, Body* attractor ) noexcept -> Point2D {
-    auto point_vector = Direction( body->GetPosition(), attractor->GetPosition() );
-    auto force_mag = AttractionMag(body, attractor);
-    return point_vector * force_mag;
+    auto vec = attractor->GetPosition() - body->GetPosition();
+    auto d2 = Dot( vec, vec );
+    if( d2 < std::numeric_limits<double>::min() )
+      return {};
+    return vec * ( G * attractor->GetMass() / ( d2 * sqrt(d2) ) );
   }
-  
 };
 
-#endif // GRAVITATION_H
\ No newline at end of file
+#endif // GRAVITATION_H
@@ -0,0 +1,183 @@
+#ifndef INTEGRATOR_H
+#define INTEGRATOR_H
+
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <cstdint>
+#include <cstdio>
+#include <numeric>
+#include <utility>
+#include <vector>
+
+#include "body_storage.h"
+#include "checkpoint.h"
+
+// Integrators are policies for World. They may hold state (BlockTimestep keeps per-body levels);
+// state that has to survive a checkpoint is persisted through SaveState/LoadState. A step is
+// composed from three World primitives: Drift( h ) advances positions, Kick( h ) advances
+// velocities with the stored accelerations and ComputeAccelerations() refreshes them from the
+// current positions of all bodies at once.
+
+struct Leapfrog{
+  static constexpr const char* NAME = "leapfrog";
+  template<typename W>
+  auto Step( W& world, double dt ) const -> void {
+    world.Drift( dt/2 );
+    world.ComputeAccelerations();
+    world.Kick( dt );
+    world.Drift( dt/2 );
+  }
+};
+
+struct VelocityVerlet{
+  static constexpr const char* NAME = "velocity_verlet";
+  // No drift follows the last ComputeAccelerations(), so World can fuse the potential into it.
+  static constexpr bool FORCE_PASS_LAST = true;
+  template<typename W>
+  auto Step( W& world, double dt ) const -> void {
+    if( !world.AccelerationsValid() )
+      world.ComputeAccelerations();
+    world.Kick( dt/2 );
+    world.Drift( dt );
+    world.ComputeAccelerations();
+    world.Kick( dt/2 );
+  }
+};
+
+// Fourth order composition of three drift-kick-drift steps (Yoshida 1990).
+struct Yoshida4{
+  static constexpr const char* NAME = "yoshida4";
+  template<typename W>
+  auto Step( W& world, double dt ) const -> void {
+    world.Drift( C1 * dt );
+    world.ComputeAccelerations();
+    world.Kick( D1 * dt );
+    world.Drift( C2 * dt );
+    world.ComputeAccelerations();
+    world.Kick( D2 * dt );
+    world.Drift( C2 * dt );
+    world.ComputeAccelerations();
+    world.Kick( D1 * dt );
+    world.Drift( C1 * dt );
+  }
+  static inline const double D1 = 1.0 / ( 2.0 - std::cbrt(2.0) );
+  static inline const double D2 = -std::cbrt(2.0) / ( 2.0 - std::cbrt(2.0) );
+  static inline const double C1 = D1 / 2;
+  static inline const double C2 = ( D1 + D2 ) / 2;
+};
+
+// Hierarchical block timesteps. Every body and test particle gets its own step dt / 2^level, chosen
+// at each of its synchronization points from the Aarseth criterion eta*|a|/|j|. Positions are drifted
+// together between consecutive block boundaries, while forces are evaluated and kicks applied only
+// for the members whose block ends there. All levels divide dt, so everything is in sync after Step.
+struct BlockTimestep{
+  static constexpr const char* NAME = "block_timestep";
+  double eta{0.02};
+  uint32_t max_level{16};
+
+  template<typename W>
+  auto Step( W& world, double dt ) -> void {
+    const auto ticks = uint64_t{1} << max_level;
+    const auto h = dt / static_cast<double>( ticks );
+    auto populations = std::array<std::pair<BodyStorage*, Population*>, 2>{ 
+      std::pair{ &world.GetBodies(), &bodies_ }, 
+      std::pair{ &world.GetParticles(), &particles_ } 
+    };
+    auto refresh = !world.AccelerationsValid();
+    for( auto [storage, p] : populations )
+      refresh = refresh || p->jx.size() != storage->Size();
+    bins_.assign( max_level + 1, 0 );
+    for( auto [storage, p] : populations ){
+      auto n = storage->Size();
+      if( refresh ){
+        p->jx.resize( n );
+        p->jy.resize( n );
+        p->active.resize( n );
+        std::iota( p->active.begin(), p->active.end(), size_t{0} );
+        world.ComputeAccelerationJerk( *storage, p->active, p->jx.data(), p->jy.data() );
+      }
+      p->level.resize( n );
+      for( size_t i=0; i<n; ++i ){
+        p->level[i] = ChooseLevel( *storage, *p, i, dt );
+        ++bins_[ p->level[i] ];
+        Kick( *storage, i, 0.5 * h * static_cast<double>( Stride( p->level[i] ) ) );
+      }
+    }
+
+    auto t = uint64_t{0};
+    while( t < ticks ){
+      auto t_next = ticks;
+      for( uint32_t l=0; l<=max_level; ++l )
+        if( bins_[l] > 0 )
+          t_next = std::min( t_next, ( t / Stride(l) + 1 ) * Stride(l) );
+      world.Drift( h * static_cast<double>( t_next - t ) );
+      t = t_next;
+
+      for( auto [storage, p] : populations ){
+        p->active.clear();
+        for( size_t i=0; i<storage->Size(); ++i )
+          if( t % Stride( p->level[i] ) == 0 )
+            p->active.push_back( i );
+        world.ComputeAccelerationJerk( *storage, p->active, p->jx.data(), p->jy.data() );
+        for( auto i : p->active ){
+          Kick( *storage, i, 0.5 * h * static_cast<double>( Stride( p->level[i] ) ) );
+          if( t == ticks )
+            continue;
+          // A member may always refine; it may only coarsen onto a level whose blocks start at t.
+          auto level = ChooseLevel( *storage, *p, i, dt );
+          while( level < p->level[i] && t % Stride(level) != 0 )
+            ++level;
+          --bins_[ p->level[i] ];
+          ++bins_[ level ];
+          p->level[i] = level;
+          Kick( *storage, i, 0.5 * h * static_cast<double>( Stride( level ) ) );
+        }
+      }
+    }
+    world.SetAccelerationsValid();
+  }
+
+  // Per-body levels and jerks are rebuilt at the start of every step, only the settings are persistent.
+  auto SaveState( std::FILE* file ) const -> void {
+    Checkpoint::Write( file, &eta, sizeof(eta) );
+    Checkpoint::Write( file, &max_level, sizeof(max_level) );
+  }
+  auto LoadState( std::FILE* file ) -> void {
+    Checkpoint::Read( file, &eta, sizeof(eta) );
+    Checkpoint::Read( file, &max_level, sizeof(max_level) );
+  }
+
+  auto GetLevels() const noexcept -> const std::vector<uint32_t>& { return bodies_.level; }
+  auto GetParticleLevels() const noexcept -> const std::vector<uint32_t>& { return particles_.level; }
+
+private:
+  struct Population{
+    std::vector<double> jx{};
+    std::vector<double> jy{};
+    std::vector<uint32_t> level{};
+    std::vector<size_t> active{};
+  };
+  auto Stride( uint32_t level ) const noexcept -> uint64_t { return uint64_t{1} << ( max_level - level ); }
+  static auto Kick( BodyStorage& s, size_t i, double dt ) noexcept -> void {
+    s.vx[i] += s.ax[i] * dt;
+    s.vy[i] += s.ay[i] * dt;
+  }
+  auto ChooseLevel( const BodyStorage& s, const Population& p, size_t i, double dt ) const noexcept -> uint32_t {
+    auto a = std::hypot( s.ax[i], s.ay[i] );
+    auto j = std::hypot( p.jx[i], p.jy[i] );
+    if( !( j > 0 ) || !( a > 0 ) )
+      return 0;
+    auto ratio = dt * j / ( eta * a );
+    if( ratio <= 1 )
+      return 0;
+    auto level = static_cast<uint32_t>( std::ceil( std::log2( ratio ) ) );
+    return std::min( level, max_level );
+  }
+
+  Population bodies_{};
+  Population particles_{};
+  std::vector<size_t> bins_{};
+};
+
+#endif // INTEGRATOR_H
@@ -0,0 +1,134 @@
+#include "body.h"
+#include "gravitation.h"
+#include "scenario.h"
+#include "world.h"
+
+#include <chrono>
+#include <cmath>
+#include <fstream>
+#include <functional>
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <vector>
+
+// Headless, reproducible benchmark of World and Gravitation.
+// Usage: physics_bench [--n N ...] [--threads T] [--out results.json]
+// Every scenario is integrated for a fixed simulated time with a fixed seed; results go out as JSON.
+
+namespace {
+
+using BenchWorld = World<Leapfrog>;
+
+struct BenchScenario{
+  std::string name;
+  std::function<void(BenchWorld&, size_t)> setup;
+  bool scalable;
+  double softening;
+  double dt;
+  double duration;
+};
+
+constexpr double DISK_RADIUS = 1e5;
+
+auto EarthMoon( BenchWorld& world, size_t ) -> void {
+  world.AddBody( TheEarth ).SetPosition( {0.0, 0.0} );
+  world.AddBody( TheMoon ).SetPosition( {380'000, 0.0} ).SetVelocity( {0.0, sqrt(Gravitation::G / 380'000)} );
+}
+
+// Light bodies on circular orbits around a dominant central mass.
+auto UniformDisk( BenchWorld& world, size_t n ) -> void {
+  world.Populate( Scenario::UniformDisk( n, { DISK_RADIUS, DISK_RADIUS / 10, 1.0, 1e-3 } ) );
+}
+
+auto Plummer( BenchWorld& world, size_t n ) -> void {
+  world.Populate( Scenario::PlummerSphere( n, { DISK_RADIUS / 4, 1.0 } ) );
+}
+
+auto DynamicalTime() -> double { return sqrt( pow( DISK_RADIUS, 3 ) / Gravitation::G ); }
+
+}
+
+auto main( int argc, char** argv ) -> int {
+  auto sizes = std::vector<size_t>{};
+  auto threads = size_t{1};
+  auto out_path = std::string{};
+  for( int i=1; i<argc; ++i ){
+    auto arg = std::string{ argv[i] };
+    if( arg == "--threads" && i+1 < argc )
+      threads = std::stoul( argv[++i] );
+    else if( arg == "--out" && i+1 < argc )
+      out_path = argv[++i];
+    else if( arg == "--n" )
+      while( i+1 < argc && argv[i+1][0] != '-' )
+        sizes.push_back( std::stoul( argv[++i] ) );
+  }
+  if( sizes.empty() )
+    sizes = { 256, 1024, 4096 };
+
+  auto t_dyn = DynamicalTime();
+  auto scenarios = std::vector<BenchScenario>{
+    { "earth_moon", EarthMoon, false, 0.0, 100.0, 2*M_PI * sqrt( pow( 380'000, 3 ) / Gravitation::G ) },
+    { "uniform_disk", UniformDisk, true, DISK_RADIUS / 100, t_dyn / 200, t_dyn },
+    { "plummer", Plummer, true, DISK_RADIUS / 100, t_dyn / 200, t_dyn },
+  };
+
+  auto json = std::ostringstream{};
+  json.precision( 10 );
+  json << "{\n  \"integrator\": \"" << Leapfrog::NAME << "\",\n  \"threads\": " << threads << ",\n  \"results\": [";
+  auto first = true;
+  for( const auto& scenario : scenarios ){
+    auto scenario_sizes = scenario.scalable ? sizes : std::vector<size_t>{ 2 };
+    for( auto n : scenario_sizes ){
+      for( auto solver : { Solver::PAIRWISE, Solver::BARNES_HUT } ){
+        auto world = BenchWorld{ solver };
+        world.SetThreadCount( threads );
+        world.SetSoftening( scenario.softening );
+        scenario.setup( world, n );
+        auto before = world.SampleDiagnostics();
+        auto force_error = solver == Solver::BARNES_HUT
+          ? QuadTree::MeasureError( world.GetBodies(), world.GetOpeningAngle(), scenario.softening * scenario.softening ).mean : 0.0;
+        auto n_steps = static_cast<size_t>( std::ceil( scenario.duration / scenario.dt ) );
+        auto start = std::chrono::steady_clock::now();
+        for( size_t s=0; s<n_steps; ++s )
+          world.Propagate( scenario.dt );
+        auto elapsed = std::chrono::duration<double>( std::chrono::steady_clock::now() - start ).count();
+        auto after = world.SampleDiagnostics();
+        auto n_bodies = static_cast<double>( world.GetBodies().Size() );
+        // Only the pairwise solver evaluates n^2 interactions per step; the tree's count is not tracked.
+        auto interactions = static_cast<double>( n_steps ) * n_bodies * n_bodies;
+        auto ns_per_interaction = std::ostringstream{};
+        if( solver == Solver::PAIRWISE )
+          ns_per_interaction << elapsed * 1e9 / interactions;
+        else
+          ns_per_interaction << "null";
+
+        json << ( first ? "\n" : ",\n" ) << "    { "
+             << "\"scenario\": \"" << scenario.name << "\", "
+             << "\"solver\": \"" << ( solver == Solver::PAIRWISE ? "pairwise" : "barnes_hut" ) << "\", "
+             << "\"n\": " << world.GetBodies().Size() << ", "
+             << "\"softening\": " << scenario.softening << ", "
+             << "\"steps\": " << n_steps << ", "
+             << "\"dt\": " << scenario.dt << ", "
+             << "\"simulated_time\": " << world.GetTime() << ", "
+             << "\"steps_per_second\": " << n_steps / elapsed << ", "
+             << "\"ns_per_interaction\": " << ns_per_interaction.str() << ", "
+             << "\"energy_drift\": " << std::fabs( ( after.TotalEnergy() - before.TotalEnergy() ) / before.TotalEnergy() ) << ", "
+             << "\"angular_momentum_drift\": " << std::fabs( ( after.angular_momentum - before.angular_momentum ) / before.angular_momentum_scale ) << ", "
+             << "\"force_error\": " << force_error << " }";
+        first = false;
+        std::cerr << scenario.name << " n=" << n << " " << ( solver == Solver::PAIRWISE ? "pairwise" : "barnes_hut" ) 
+                  << ": " << n_steps / elapsed << " steps/s\n";
+      }
+    }
+  }
+  json << "\n  ]\n}\n";
+
+  if( out_path.empty() ){
+    std::cout << json.str();
+  } else {
+    auto file = std::ofstream{ out_path };
+    file << json.str();
+  }
+  return 0;
+}
@@ -1,25 +1,36 @@
 #include "body.h"
 #include "gravitation.h"
+#include "trajectory.h"
 #include "world.h"
 #include <cmath>
+#include <cstdlib>
+#include <string>
 
-int main(){
-  auto earth = new Body{ TheEarth };
-  auto moon = new Body{ TheMoon };
-
-  earth->SetPosition({0.0, 0.0});
-  moon->SetPosition( {380'000, 0.0} );
-  moon->SetVelocity({0.0, sqrt(Gravitation::G / 380'000)});
+// Usage: physics_test [steps] [trajectory file]
+int main( int argc, char** argv ){
+  auto n_steps = argc > 1 ? std::strtoul( argv[1], nullptr, 10 ) : 100'000ul;
+  auto path = argc > 2 ? std::string{ argv[2] } : std::string{ "earth_moon.gtraj" };
 
   auto world = World{};
-  world.AddBody(earth);
-  world.AddBody(moon);
+  auto earth = world.AddBody( TheEarth );
+  auto moon = world.AddBody( TheMoon );
 
-  while( true ){
-    world.Propagate(100);
+  earth.SetPosition({0.0, 0.0});
+  moon.SetPosition( {380'000, 0.0} );
+  moon.SetVelocity({0.0, sqrt(Gravitation::G / 380'000)});
 
-    moon->GetPosition().Print();
-    earth->GetPosition().Print();
+  {
+    auto writer = TrajectoryWriter{ path };
+    world.RegisterRecorder( writer );
+    for( size_t i=0; i<n_steps; ++i )
+      world.Propagate(100);
+    world.UnregisterRecorder();
   }
+
+  auto reader = TrajectoryReader{ path };
+  auto last = reader.GetFrame( reader.GetFrameCount() - 1 );
+  std::cout << reader.GetFrameCount() << " frames in " << path << ", t = " << last.time << "\n";
+  last.bodies[1].Print();
+  last.bodies[0].Print();
   return 0;
-}
\ No newline at end of file
+}
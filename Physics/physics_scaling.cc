@@ -0,0 +1,63 @@
+#include "body.h"
+#include "world.h"
+
+#include <chrono>
+#include <cmath>
+#include <cstdlib>
+#include <iostream>
+#include <random>
+#include <string>
+#include <thread>
+#include <vector>
+
+// Steps per second of World::Propagate against the number of threads.
+// Usage: physics_scaling [pairwise|bh] [N ...]
+auto main( int argc, char** argv ) -> int {
+  auto solver = Solver::PAIRWISE;
+  auto sizes = std::vector<size_t>{};
+  for( int i=1; i<argc; ++i ){
+    auto arg = std::string{argv[i]};
+    if( arg == "bh" )
+      solver = Solver::BARNES_HUT;
+    else if( arg != "pairwise" )
+      sizes.push_back( std::stoul(arg) );
+  }
+  if( sizes.empty() )
+    sizes = { 1'000, 10'000, 100'000 };
+  auto max_threads = std::max( std::thread::hardware_concurrency(), 1u );
+  auto thread_counts = std::vector<unsigned>{};
+  for( auto t = 1u; t < max_threads; t *= 2 )
+    thread_counts.push_back( t );
+  thread_counts.push_back( max_threads );
+
+  std::cout << "N\tthreads\tsteps/s\tspeedup\n";
+  for( auto n : sizes ){
+    auto single = 0.0;
+    for( auto threads : thread_counts ){
+      auto world = World{ solver };
+      world.SetThreadCount( threads );
+      world.Reserve( n );
+      auto rng = std::mt19937_64{ 42 };
+      auto uniform = std::uniform_real_distribution<double>{ 0.0, 1.0 };
+      for( size_t i=0; i<n; ++i ){
+        auto r = 1e6 * sqrt( uniform(rng) );
+        auto phi = 2*M_PI * uniform(rng);
+        world.AddBody( Body{ 1.0 / n, 1.0 } ).SetPosition( { r*cos(phi), r*sin(phi) } );
+      }
+      world.Propagate( 1.0 );
+      auto steps = 0;
+      auto start = std::chrono::steady_clock::now();
+      auto elapsed = 0.0;
+      while( elapsed < 1.0 ){
+        world.Propagate( 1.0 );
+        ++steps;
+        elapsed = std::chrono::duration<double>( std::chrono::steady_clock::now() - start ).count();
+      }
+      auto rate = steps / elapsed;
+      if( threads == 1 )
+        single = rate;
+      std::cout << n << "\t" << threads << "\t" << rate << "\t" << rate / single << "\n";
+    }
+  }
+  return 0;
+}
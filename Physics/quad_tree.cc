@@ -0,0 +1,129 @@
+#include "quad_tree.h"
+#include "gravitation.h"
+
+#include <algorithm>
+
+auto QuadTree::Build( const BodyStorage& bodies ) -> void {
+  nodes_.clear();
+  bodies_ = &bodies;
+  if( bodies.Empty() )
+    return;
+  auto [lo_x, hi_x] = std::minmax_element( bodies.x.begin(), bodies.x.end() );
+  auto [lo_y, hi_y] = std::minmax_element( bodies.y.begin(), bodies.y.end() );
+  auto lo = Point2D{ *lo_x, *lo_y };
+  auto hi = Point2D{ *hi_x, *hi_y };
+  auto half_size = std::max( hi.x - lo.x, hi.y - lo.y ) / 2 * 1.0001;
+  half_size = std::max( half_size, std::numeric_limits<double>::min() );
+  AddNode( (lo + hi) / 2, half_size );
+  for( size_t i=0; i<bodies.Size(); ++i )
+    Insert( static_cast<int32_t>(i) );
+  for( auto& n : nodes_ ){
+    if( n.IsLeaf() && n.body != EMPTY && n.mass == bodies.mass[n.body] )
+      n.center_mass = PositionOf( n.body );
+    else if( n.mass > 0 )
+      n.center_mass /= n.mass;
+  }
+}
+
+auto QuadTree::Acceleration( const Point2D& position, double opening_angle, double softening2,
+                             double* potential ) const noexcept -> Point2D {
+  auto acceleration = Point2D{};
+  if( potential )
+    *potential = 0.0;
+  if( nodes_.empty() )
+    return acceleration;
+  auto theta2 = opening_angle * opening_angle;
+  int32_t stack[4 * MAX_DEPTH + 4];
+  auto top = 0;
+  stack[top++] = 0;
+  while( top > 0 ){
+    const auto& node = nodes_[ stack[--top] ];
+    if( node.mass <= 0 )
+      continue;
+    auto d = node.center_mass - position;
+    auto d2 = Dot(d, d);
+    auto width = 2 * node.half_size;
+    auto inside = fabs( position.x - node.center.x ) <= node.half_size && fabs( position.y - node.center.y ) <= node.half_size;
+    if( !node.IsLeaf() && ( inside || width * width >= theta2 * d2 ) ){
+      for( auto c : node.children )
+        stack[top++] = c;
+      continue;
+    }
+    if( d2 < std::numeric_limits<double>::min() )
+      continue;
+    auto s2 = d2 + softening2;
+    auto inv_s = 1.0 / sqrt( s2 );
+    acceleration += d * ( Gravitation::G * node.mass * inv_s * inv_s * inv_s );
+    if( potential )
+      *potential -= Gravitation::G * node.mass * inv_s;
+  }
+  return acceleration;
+}
+
+auto QuadTree::Insert( int32_t body ) -> void {
+  auto position = PositionOf( body );
+  auto mass = bodies_->mass[body];
+  auto node = int32_t{0};
+  for( auto depth = 0; ; ++depth ){
+    if( nodes_[node].IsLeaf() ){
+      if( nodes_[node].body == EMPTY && nodes_[node].mass <= 0 ){
+        nodes_[node].body = body;
+        nodes_[node].center_mass = position * mass;
+        nodes_[node].mass = mass;
+        return;
+      }
+      if( depth >= MAX_DEPTH ){
+        nodes_[node].center_mass += position * mass;
+        nodes_[node].mass += mass;
+        return;
+      }
+      auto resident = nodes_[node].body;
+      Split( node );
+      nodes_[node].body = EMPTY;
+      auto& child = nodes_[ nodes_[node].children[ Quadrant(nodes_[node], PositionOf(resident)) ] ];
+      child.body = resident;
+      child.mass = bodies_->mass[resident];
+      child.center_mass = PositionOf(resident) * child.mass;
+    }
+    auto& n = nodes_[node];
+    n.center_mass += position * mass;
+    n.mass += mass;
+    node = n.children[ Quadrant(n, position) ];
+  }
+}
+
+auto QuadTree::Split( int32_t node ) -> void {
+  auto quarter = nodes_[node].half_size / 2;
+  auto center = nodes_[node].center;
+  for( int32_t q=0; q<4; ++q ){
+    auto offset = Point2D{ (q & 1) ? quarter : -quarter, (q & 2) ? quarter : -quarter };
+    nodes_[node].children[q] = AddNode( center + offset, quarter );
+  }
+}
+
+auto QuadTree::AddNode( const Point2D& center, double half_size ) -> int32_t {
+  auto& n = nodes_.emplace_back();
+  n.center = center;
+  n.half_size = half_size;
+  return static_cast<int32_t>( nodes_.size() - 1 );
+}
+
+auto QuadTree::Quadrant( const Node& node, const Point2D& position ) noexcept -> int32_t {
+  return ( position.x >= node.center.x ? 1 : 0 ) | ( position.y >= node.center.y ? 2 : 0 );
+}
+
+auto QuadTree::MeasureError( const BodyStorage& bodies, double opening_angle, double softening2 ) -> ForceError {
+  auto exact = bodies;
+  Gravitation::Accelerate( exact, exact, 0, exact.Size(), softening2 );
+  auto tree = QuadTree{};
+  tree.Build( exact );
+  auto error = ForceError{};
+  for( size_t i=0; i<exact.Size(); ++i ){
+    auto reference = Point2D{ exact.ax[i], exact.ay[i] };
+    auto approximate = tree.Acceleration( { exact.x[i], exact.y[i] }, opening_angle, softening2 );
+    auto relative = reference.Mag() > 0 ? ( approximate - reference ).Mag() / reference.Mag() : 0.0;
+    error.mean += relative / exact.Size();
+    error.max = std::max( error.max, relative );
+  }
+  return error;
+}
@@ -0,0 +1,52 @@
+#ifndef QUAD_TREE_H
+#define QUAD_TREE_H
+
+#include <array>
+#include <cstdint>
+#include <vector>
+
+#include "body_storage.h"
+#include "coordinates.h"
+
+class QuadTree{
+public:
+  struct ForceError{
+    double mean{};
+    double max{};
+  };
+  QuadTree() = default;
+
+  auto Build( const BodyStorage& bodies ) -> void;
+  // If potential is given, it receives the potential at position from the same traversal.
+  auto Acceleration( const Point2D& position, double opening_angle, double softening2 = 0.0,
+                     double* potential = nullptr ) const noexcept -> Point2D;
+
+  auto Size() const noexcept -> size_t { return nodes_.size(); }
+
+  // Relative deviation of the tree accelerations of all bodies from the exact pairwise sum. O(N^2),
+  // for tests and benchmarks.
+  static auto MeasureError( const BodyStorage& bodies, double opening_angle, double softening2 = 0.0 ) -> ForceError;
+
+private:
+  static constexpr int32_t EMPTY = -1;
+  static constexpr int32_t MAX_DEPTH = 64;
+  struct Node{
+    Point2D center{};
+    double half_size{};
+    Point2D center_mass{};
+    double mass{};
+    std::array<int32_t, 4> children{ EMPTY, EMPTY, EMPTY, EMPTY };
+    int32_t body{EMPTY};
+    auto IsLeaf() const noexcept -> bool { return children[0] == EMPTY; }
+  };
+  auto Insert( int32_t body ) -> void;
+  auto PositionOf( int32_t body ) const noexcept -> Point2D { return { bodies_->x[body], bodies_->y[body] }; }
+  auto Split( int32_t node ) -> void;
+  auto AddNode( const Point2D& center, double half_size ) -> int32_t;
+  static auto Quadrant( const Node& node, const Point2D& position ) noexcept -> int32_t;
+
+  std::vector<Node> nodes_{};
+  const BodyStorage* bodies_{nullptr};
+};
+
+#endif // QUAD_TREE_H
@@ -0,0 +1,36 @@
+#include "quad_tree.h"
+#include "scenario.h"
+
+#include <cstdio>
+#include <string>
+
+// Checks the Barnes-Hut accelerations at the default opening angle against the exact pairwise sum.
+// Exits with a non-zero status if an error bound is exceeded. The max bounds are loose because the
+// relative error is largest where the net force nearly cancels, e.g. on the central mass of a disk.
+
+namespace {
+
+constexpr double OPENING_ANGLE = 0.5;
+constexpr size_t N = 4000;
+
+auto Measure( const Scenario::Generator& generator, double softening ) -> QuadTree::ForceError {
+  auto bodies = BodyStorage{};
+  generator( bodies, nullptr );
+  return QuadTree::MeasureError( bodies, OPENING_ANGLE, softening * softening );
+}
+
+auto Check( const std::string& name, const QuadTree::ForceError& errors, double mean_bound, double max_bound ) -> bool {
+  auto ok = errors.mean < mean_bound && errors.max < max_bound;
+  std::printf( "%-14s mean %.2e (< %.0e)  max %.2e (< %.0e)  %s\n", name.c_str(), errors.mean, mean_bound, 
+               errors.max, max_bound, ok ? "ok" : "FAILED" );
+  return ok;
+}
+
+}
+
+auto main() -> int {
+  constexpr double RADIUS = 1e5;
+  auto ok = Check( "uniform_disk", Measure( Scenario::UniformDisk( N, { RADIUS, RADIUS / 10, 1.0, 1e-3 }, 1 ), RADIUS / 100 ), 1e-4, 0.2 );
+  ok = Check( "plummer", Measure( Scenario::PlummerSphere( N, { RADIUS / 4, 1.0 }, 1 ), RADIUS / 100 ), 3e-2, 1.0 ) && ok;
+  return ok ? 0 : 1;
+}
@@ -0,0 +1,290 @@
+#include "scenario.h"
+
+#include <algorithm>
+#include <charconv>
+#include <cmath>
+#include <cstdio>
+#include <cstring>
+#include <memory>
+#include <random>
+#include <stdexcept>
+#include <utility>
+#include <vector>
+
+#include "gravitation.h"
+
+namespace Scenario{
+
+namespace {
+
+constexpr size_t BLOCK_SIZE = 4096;
+constexpr size_t CHUNK_SIZE = size_t{1} << 20;
+
+using File = std::unique_ptr<std::FILE, int(*)(std::FILE*)>;
+
+auto Open( const std::string& path, const char* mode ) -> File {
+  auto file = File{ std::fopen( path.c_str(), mode ), &std::fclose };
+  if( !file )
+    throw std::runtime_error( "Scenario: cannot open " + path );
+  return file;
+}
+
+auto RemainingBytes( std::FILE* file ) -> uint64_t {
+  auto position = std::ftell( file );
+  if( position < 0 || std::fseek( file, 0, SEEK_END ) != 0 )
+    throw std::runtime_error( "Scenario: body file is not seekable" );
+  auto end = std::ftell( file );
+  if( end < position || std::fseek( file, position, SEEK_SET ) != 0 )
+    throw std::runtime_error( "Scenario: body file is not seekable" );
+  return static_cast<uint64_t>( end - position );
+}
+
+auto SplitMix64( uint64_t x ) noexcept -> uint64_t {
+  x += 0x9e3779b97f4a7c15ull;
+  x = ( x ^ ( x >> 30 ) ) * 0xbf58476d1ce4e5b9ull;
+  x = ( x ^ ( x >> 27 ) ) * 0x94d049bb133111ebull;
+  return x ^ ( x >> 31 );
+}
+
+// Independent random stream of one block of bodies.
+class Stream{
+public:
+  Stream( uint64_t seed, uint64_t block ) : rng_{ SplitMix64( seed ^ SplitMix64( block ) ) } {}
+  // Uniform in [0, 1), bit-identical across standard libraries.
+  auto Uniform() noexcept -> double { return static_cast<double>( rng_() >> 11 ) * 0x1.0p-53; }
+private:
+  std::mt19937_64 rng_;
+};
+
+auto Set( BodyStorage& s, size_t i, Point2D pos, Point2D vel, double mass, double radius ) noexcept -> void {
+  s.x[i] = pos.x;
+  s.y[i] = pos.y;
+  s.vx[i] = vel.x;
+  s.vy[i] = vel.y;
+  s.mass[i] = mass;
+  s.radius[i] = radius;
+}
+
+// Calls body( stream, index ) for [first, first+n), block by block, blocks spread over the pool.
+template<typename F>
+auto Fill( size_t first, size_t n, uint64_t seed, ThreadPool* pool, const F& body ) -> void {
+  auto n_blocks = ( n + BLOCK_SIZE - 1 ) / BLOCK_SIZE;
+  auto run = [&]( size_t block_begin, size_t block_end ){
+    for( auto b=block_begin; b<block_end; ++b ){
+      auto stream = Stream{ seed, b };
+      auto end = first + std::min( n, (b+1) * BLOCK_SIZE );
+      for( auto i = first + b*BLOCK_SIZE; i<end; ++i )
+        body( stream, i );
+    }
+  };
+  if( pool )
+    pool->ParallelFor( 0, n_blocks, 1, run );
+  else
+    run( 0, n_blocks );
+}
+
+auto CircularVelocity( Point2D pos, double enclosed_mass ) noexcept -> Point2D {
+  auto r = pos.Mag();
+  auto v = r > 0 ? std::sqrt( Gravitation::G * enclosed_mass / r ) : 0.0;
+  return r > 0 ? Point2D{ -pos.y, pos.x } * ( v / r ) : Point2D{};
+}
+
+// sin of the polar angle of an isotropic direction.
+auto SinPolar( Stream& rng ) -> double {
+  auto cos_theta = 2*rng.Uniform() - 1;
+  return std::sqrt( std::max( 1 - cos_theta*cos_theta, 0.0 ) );
+}
+
+auto Trim( const char*& begin, const char*& end ) noexcept -> void {
+  while( begin < end && ( *begin == ' ' || *begin == '\t' ) )
+    ++begin;
+  while( end > begin && ( end[-1] == ' ' || end[-1] == '\t' || end[-1] == '\r' ) )
+    --end;
+}
+
+// Reads the file in fixed chunks and hands every line, without its '\n', to line( begin, end ).
+template<typename F>
+auto ForEachLine( std::FILE* file, const F& line ) -> void {
+  auto buffer = std::vector<char>( CHUNK_SIZE );
+  auto carry = size_t{0};
+  while( true ){
+    auto n_read = std::fread( buffer.data() + carry, 1, buffer.size() - carry, file );
+    const char* begin = buffer.data();
+    const char* end = buffer.data() + carry + n_read;
+    for( auto newline = std::find( begin, end, '\n' ); newline != end; newline = std::find( begin, end, '\n' ) ){
+      line( begin, newline );
+      begin = newline + 1;
+    }
+    carry = static_cast<size_t>( end - begin );
+    if( n_read == 0 ){
+      if( carry > 0 )
+        line( begin, end );
+      return;
+    }
+    std::memmove( buffer.data(), begin, carry );
+    if( carry == buffer.size() )
+      buffer.resize( 2 * buffer.size() );
+  }
+}
+
+// Parses "x,y,vx,vy,mass[,radius]" into values; returns the number of fields, 0 if malformed.
+auto ParseLine( const char* begin, const char* end, double (&values)[6] ) noexcept -> size_t {
+  auto n = size_t{0};
+  while( true ){
+    auto next = std::find( begin, end, ',' );
+    auto field_end = next;
+    Trim( begin, field_end );
+    if( n == 6 )
+      return 0;
+    auto [ptr, ec] = std::from_chars( begin, field_end, values[n] );
+    if( ec != std::errc{} || ptr != field_end )
+      return 0;
+    ++n;
+    if( next == end )
+      break;
+    begin = next + 1;
+  }
+  return n >= 5 ? n : 0;
+}
+
+}
+
+auto UniformDisk( size_t n, const Disk& disk, uint64_t seed ) -> Generator {
+  return [n, disk, seed]( BodyStorage& s, ThreadPool* pool ){
+    if( n == 0 )
+      return;
+    auto first = s.Size();
+    s.Resize( first + n );
+    Set( s, first, {}, {}, disk.central_mass, disk.body_radius );
+    auto mass = n > 1 ? disk.disk_mass / (n-1) : 0.0;
+    auto inner2 = disk.inner_radius * disk.inner_radius;
+    auto area = std::max( disk.radius * disk.radius - inner2, 1e-300 );
+    Fill( first+1, n-1, seed, pool, [&]( Stream& rng, size_t i ){
+      auto r2 = inner2 + area * rng.Uniform();
+      auto r = std::sqrt( r2 );
+      auto phi = 2*M_PI * rng.Uniform();
+      auto pos = Point2D{ r*std::cos(phi), r*std::sin(phi) };
+      auto enclosed = disk.central_mass + disk.disk_mass * ( r2 - inner2 ) / area;
+      Set( s, i, pos, CircularVelocity( pos, enclosed ), mass, disk.body_radius );
+    } );
+  };
+}
+
+auto PlummerSphere( size_t n, const Plummer& plummer, uint64_t seed ) -> Generator {
+  return [n, plummer, seed]( BodyStorage& s, ThreadPool* pool ){
+    auto first = s.Size();
+    s.Resize( first + n );
+    const auto a = plummer.scale_radius;
+    const auto mass = n > 0 ? plummer.total_mass / n : 0.0;
+    Fill( first, n, seed, pool, [&]( Stream& rng, size_t i ){
+      auto r = a / std::sqrt( std::pow( rng.Uniform() * 0.999 + 1e-6, -2.0/3.0 ) - 1.0 );
+      auto q = 0.0;
+      auto g = 0.1;
+      do{
+        q = rng.Uniform();
+        g = 0.1 * rng.Uniform();
+      } while( g > q*q * std::pow( 1 - q*q, 3.5 ) );
+      auto v = q * std::sqrt( 2 * Gravitation::G * plummer.total_mass / std::sqrt( r*r + a*a ) );
+      // r and v are 3D magnitudes with isotropic directions; keep their in-plane components.
+      auto r_plane = r * SinPolar( rng );
+      auto v_plane = v * SinPolar( rng );
+      auto phi = 2*M_PI * rng.Uniform();
+      auto psi = 2*M_PI * rng.Uniform();
+      Set( s, i, { r_plane*std::cos(phi), r_plane*std::sin(phi) }, { v_plane*std::cos(psi), v_plane*std::sin(psi) },
+           mass, plummer.body_radius );
+    } );
+  };
+}
+
+auto KeplerianRing( size_t n, const Ring& ring, uint64_t seed ) -> Generator {
+  return [n, ring, seed]( BodyStorage& s, ThreadPool* pool ){
+    if( n == 0 )
+      return;
+    auto first = s.Size();
+    s.Resize( first + n );
+    Set( s, first, {}, {}, ring.central_mass, ring.body_radius );
+    auto mass = n > 1 ? ring.ring_mass / (n-1) : 0.0;
+    Fill( first+1, n-1, seed, pool, [&]( Stream& rng, size_t i ){
+      auto r = ring.radius + ring.width * ( rng.Uniform() - 0.5 );
+      auto phi = 2*M_PI * rng.Uniform();
+      auto pos = Point2D{ r*std::cos(phi), r*std::sin(phi) };
+      Set( s, i, pos, CircularVelocity( pos, ring.central_mass ), mass, ring.body_radius );
+    } );
+  };
+}
+
+auto LoadCsv( const std::string& path ) -> Generator {
+  return [path]( BodyStorage& s, ThreadPool* ){
+    auto file = Open( path, "rb" );
+    auto first = s.Size();
+    auto line_number = size_t{0};
+    auto header_allowed = true;
+    auto parse = [&]( const char* begin, const char* end ){
+      ++line_number;
+      Trim( begin, end );
+      if( begin == end || *begin == '#' )
+        return;
+      double values[6]{};
+      auto n_fields = ParseLine( begin, end, values );
+      auto is_first = std::exchange( header_allowed, false );
+      if( n_fields == 0 ){
+        if( is_first )
+          return;
+        throw std::runtime_error( "Scenario: " + path + ":" + std::to_string(line_number) + ": expected x,y,vx,vy,mass[,radius]" );
+      }
+      s.x.push_back( values[0] );
+      s.y.push_back( values[1] );
+      s.vx.push_back( values[2] );
+      s.vy.push_back( values[3] );
+      s.mass.push_back( values[4] );
+      s.radius.push_back( n_fields > 5 ? values[5] : 0.0 );
+    };
+    try{
+      ForEachLine( file.get(), parse );
+    } catch( ... ){
+      s.Resize( first );
+      throw;
+    }
+    // The parsed columns are longer than ax, ay and id now; Resize completes those.
+    s.Resize( s.x.size() );
+  };
+}
+
+auto LoadBinary( const std::string& path ) -> Generator {
+  return [path]( BodyStorage& s, ThreadPool* ){
+    auto file = Open( path, "rb" );
+    auto header = BodyFileHeader{};
+    if( std::fread( &header, sizeof(header), 1, file.get() ) != 1
+        || std::memcmp( header.magic, BodyFileHeader::MAGIC, sizeof(header.magic) ) != 0
+        || header.version != BodyFileHeader::VERSION || header.n_columns != 6 )
+      throw std::runtime_error( "Scenario: " + path + " is not a version " + std::to_string(BodyFileHeader::VERSION) + " body file" );
+    if( header.n_bodies > RemainingBytes( file.get() ) / ( 6 * sizeof(double) ) )
+      throw std::runtime_error( "Scenario: " + path + " is shorter than its header says" );
+    auto first = s.Size();
+    s.Resize( first + header.n_bodies );
+    for( auto* column : { &s.x, &s.y, &s.vx, &s.vy, &s.mass, &s.radius } )
+      if( std::fread( column->data() + first, sizeof(double), header.n_bodies, file.get() ) != header.n_bodies ){
+        s.Resize( first );
+        throw std::runtime_error( "Scenario: unexpected end of " + path );
+      }
+  };
+}
+
+auto Load( const std::string& path ) -> Generator {
+  auto is_csv = path.size() >= 4 && path.compare( path.size() - 4, 4, ".csv" ) == 0;
+  return is_csv ? LoadCsv( path ) : LoadBinary( path );
+}
+
+auto SaveBinary( const std::string& path, const BodyStorage& storage ) -> void {
+  auto file = Open( path, "wb" );
+  auto header = BodyFileHeader{};
+  std::memcpy( header.magic, BodyFileHeader::MAGIC, sizeof(header.magic) );
+  header.n_bodies = storage.Size();
+  auto ok = std::fwrite( &header, sizeof(header), 1, file.get() ) == 1;
+  for( const auto* column : { &storage.x, &storage.y, &storage.vx, &storage.vy, &storage.mass, &storage.radius } )
+    ok = ok && std::fwrite( column->data(), sizeof(double), column->size(), file.get() ) == column->size();
+  if( !ok )
+    throw std::runtime_error( "Scenario: write to " + path + " failed" );
+}
+
+}
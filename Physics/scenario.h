@@ -0,0 +1,73 @@
+#ifndef SCENARIO_H
+#define SCENARIO_H
+
+#include <cstdint>
+#include <functional>
+#include <string>
+
+#include "body_storage.h"
+#include "thread_pool.h"
+
+// Initial conditions for World::Populate. A Generator appends its bodies to the storage in one
+// Resize and then fills the columns directly, in parallel when a pool is given.
+//
+// The random generators split the bodies into fixed blocks, each with its own RNG stream derived
+// from (seed, block). The result depends on the seed only, not on the thread count or scheduling.
+namespace Scenario{
+
+using Generator = std::function<void(BodyStorage&, ThreadPool*)>;
+
+// Bodies on circular orbits, spread uniformly over an annulus around a central mass.
+struct Disk{
+  double radius{1e5};
+  double inner_radius{1e4};
+  double central_mass{1.0};
+  double disk_mass{1e-3};
+  double body_radius{0.0};
+};
+
+// Plummer sphere (Aarseth, Henon & Wielen 1974) projected onto the plane: positions and velocities
+// are sampled in 3D and the out-of-plane components dropped. The projected system is not in
+// equilibrium under 2D dynamics.
+struct Plummer{
+  double scale_radius{2.5e4};
+  double total_mass{1.0};
+  double body_radius{0.0};
+};
+
+// Narrow ring of test-mass-like bodies on Keplerian orbits around a central mass.
+struct Ring{
+  double radius{1e5};
+  double width{1e3};
+  double central_mass{1.0};
+  double ring_mass{1e-6};
+  double body_radius{0.0};
+};
+
+// n counts the central mass, which is always the first body appended.
+auto UniformDisk( size_t n, const Disk& disk = {}, uint64_t seed = 42 ) -> Generator;
+auto PlummerSphere( size_t n, const Plummer& plummer = {}, uint64_t seed = 42 ) -> Generator;
+auto KeplerianRing( size_t n, const Ring& ring = {}, uint64_t seed = 42 ) -> Generator;
+
+// Body lists on disk. CSV has one body per line as "x,y,vx,vy,mass[,radius]"; blank lines, lines
+// starting with '#' and one header line before the first body are skipped. The binary format is a
+// BodyFileHeader followed by the x, y, vx, vy, mass and radius columns. Both are read in chunks
+// straight into the storage columns. Errors throw std::runtime_error.
+struct BodyFileHeader{
+  static constexpr char MAGIC[8] = { 'G', 'B', 'O', 'D', 'I', 'E', 'S', '\0' };
+  static constexpr uint32_t VERSION = 1;
+  char magic[8]{};
+  uint32_t version{VERSION};
+  uint32_t n_columns{6};
+  uint64_t n_bodies{};
+};
+
+auto LoadCsv( const std::string& path ) -> Generator;
+auto LoadBinary( const std::string& path ) -> Generator;
+// Picks the format from the extension: ".csv" is CSV, anything else binary.
+auto Load( const std::string& path ) -> Generator;
+auto SaveBinary( const std::string& path, const BodyStorage& storage ) -> void;
+
+}
+
+#endif // SCENARIO_H
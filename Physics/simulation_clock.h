@@ -0,0 +1,75 @@
+#ifndef SIMULATION_CLOCK_H
+#define SIMULATION_CLOCK_H
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+
+// Drives a World in fixed steps from wall-clock time. Elapsed wall time, multiplied by the time
+// scale, goes into an accumulator that is drained one `step` at a time. If the World cannot keep
+// up, at most `max_substeps` are run per Advance() and the rest of the backlog is dropped, so a
+// slow step never snowballs into ever longer catch-up phases.
+class SimulationClock{
+public:
+  using Clock = std::chrono::steady_clock;
+
+  SimulationClock( double step, double time_scale = 1.0, size_t max_substeps = 8 ) :
+    step_(step), time_scale_(Paused( time_scale ) ? 0.0 : time_scale), max_substeps_(std::max( max_substeps, size_t{1} )) {}
+
+  // 0 pauses the simulation; negative (or NaN) scales are treated as 0, time never runs backwards.
+  auto SetTimeScale( double time_scale ) noexcept -> SimulationClock& {
+    time_scale_ = Paused( time_scale ) ? 0.0 : time_scale;
+    return *this;
+  }
+  auto SetMaxSubsteps( size_t n ) noexcept -> SimulationClock& { max_substeps_ = std::max( n, size_t{1} ); return *this; }
+  auto GetStep() const noexcept -> double { return step_; }
+  auto GetTimeScale() const noexcept -> double { return time_scale_; }
+  // Fraction of a step that is accumulated but not simulated yet, in [0, 1).
+  auto GetAlpha() const noexcept -> double { return accumulator_ / step_; }
+  auto GetDroppedTime() const noexcept -> double { return dropped_; }
+  // Wall-clock point at which the accumulator holds a full step again, but at most MAX_WAIT after the
+  // last Tick(), so a loop sleeping until then keeps ticking while paused and notices a new scale.
+  auto GetNextStepTime() const noexcept -> Clock::time_point {
+    auto wait = Paused( time_scale_ ) ? MAX_WAIT : std::min( ( step_ - accumulator_ ) / time_scale_, MAX_WAIT );
+    return last_tick_ + std::chrono::duration_cast<Clock::duration>( std::chrono::duration<double>( wait ) );
+  }
+
+  template<typename W>
+  auto Advance( W& world, double wall_seconds ) -> size_t {
+    accumulator_ += wall_seconds * time_scale_;
+    auto n_steps = size_t{0};
+    while( accumulator_ >= step_ && n_steps < max_substeps_ ){
+      world.Propagate( step_ );
+      accumulator_ -= step_;
+      ++n_steps;
+    }
+    if( accumulator_ >= step_ ){
+      dropped_ += accumulator_ - std::fmod( accumulator_, step_ );
+      accumulator_ = std::fmod( accumulator_, step_ );
+    }
+    return n_steps;
+  }
+  // Advances by the wall time since the previous Tick(); the first call only starts the clock.
+  template<typename W>
+  auto Tick( W& world ) -> size_t {
+    auto now = Clock::now();
+    auto elapsed = started_ ? std::chrono::duration<double>( now - last_tick_ ).count() : 0.0;
+    started_ = true;
+    last_tick_ = now;
+    return Advance( world, elapsed );
+  }
+
+private:
+  static constexpr double MAX_WAIT = 0.1;
+  static auto Paused( double time_scale ) noexcept -> bool { return !( time_scale > 0 ); }
+
+  double step_;
+  double time_scale_;
+  size_t max_substeps_;
+  double accumulator_{0.0};
+  double dropped_{0.0};
+  bool started_{false};
+  Clock::time_point last_tick_{Clock::now()};
+};
+
+#endif // SIMULATION_CLOCK_H
@@ -0,0 +1,40 @@
+#ifndef SNAPSHOT_H
+#define SNAPSHOT_H
+
+#include <vector>
+
+#include "body_storage.h"
+#include "triple_buffer.h"
+
+// Immutable copy of everything a renderer needs from one World step. Buffers are reused between
+// frames, so once they reached their size publishing a snapshot does not allocate.
+struct WorldSnapshot{
+  double time{};
+  size_t steps{};
+  std::vector<size_t> id{};
+  std::vector<double> x{};
+  std::vector<double> y{};
+  std::vector<double> radius{};
+  std::vector<size_t> particle_id{};
+  std::vector<double> particle_x{};
+  std::vector<double> particle_y{};
+
+  auto Size() const noexcept -> size_t { return id.size(); }
+  auto GetPosition( size_t index ) const noexcept -> Point2D { return { x[index], y[index] }; }
+  auto GetParticlePosition( size_t index ) const noexcept -> Point2D { return { particle_x[index], particle_y[index] }; }
+  auto Assign( double t, size_t n_steps, const BodyStorage& bodies, const BodyStorage& particles ) -> void {
+    time = t;
+    steps = n_steps;
+    id.assign( bodies.id.begin(), bodies.id.end() );
+    x.assign( bodies.x.begin(), bodies.x.end() );
+    y.assign( bodies.y.begin(), bodies.y.end() );
+    radius.assign( bodies.radius.begin(), bodies.radius.end() );
+    particle_id.assign( particles.id.begin(), particles.id.end() );
+    particle_x.assign( particles.x.begin(), particles.x.end() );
+    particle_y.assign( particles.y.begin(), particles.y.end() );
+  }
+};
+
+using SnapshotBuffer = TripleBuffer<WorldSnapshot>;
+
+#endif // SNAPSHOT_H
@@ -0,0 +1,141 @@
+#include "trajectory.h"
+
+#include <algorithm>
+#include <cstring>
+#include <stdexcept>
+#include <string>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+static_assert( sizeof(TrajectoryHeader) % 8 == 0 );
+static_assert( sizeof(TrajectoryFrameHeader) % 8 == 0 );
+static_assert( sizeof(Point2D) == 2*sizeof(double) );
+
+TrajectoryWriter::TrajectoryWriter( const std::string& path, size_t buffer_size ) : 
+  file_{ std::fopen( path.c_str(), "wb" ) }, 
+  buffer_size_{ std::max( buffer_size, sizeof(TrajectoryFrameHeader) ) } {
+  if( !file_ )
+    throw std::runtime_error( "TrajectoryWriter: cannot open " + path );
+  buffer_.reserve( buffer_size_ );
+  auto header = TrajectoryHeader{};
+  std::memcpy( header.magic, TrajectoryHeader::MAGIC, sizeof(header.magic) );
+  Append( &header, sizeof(header) );
+}
+
+TrajectoryWriter::~TrajectoryWriter(){
+  try{
+    Close();
+  } catch( ... ){}
+}
+
+auto TrajectoryWriter::Write( double time, const BodyStorage& bodies, const BodyStorage& particles ) -> void {
+  offsets_.push_back( offset_ );
+  auto frame = TrajectoryFrameHeader{ time, bodies.Size(), particles.Size(), 0 };
+  Append( &frame, sizeof(frame) );
+  AppendPoints( bodies );
+  AppendPoints( particles );
+}
+
+auto TrajectoryWriter::Close() -> void {
+  if( !file_ )
+    return;
+  // The file is closed even if finishing it fails, so the destructor does not try again; the header
+  // then keeps index_offset 0, which readers reject.
+  auto ok = true;
+  try{
+    auto index_offset = offset_;
+    Append( offsets_.data(), offsets_.size() * sizeof(uint64_t) );
+    Flush();
+    auto header = TrajectoryHeader{};
+    std::memcpy( header.magic, TrajectoryHeader::MAGIC, sizeof(header.magic) );
+    header.n_frames = offsets_.size();
+    header.index_offset = index_offset;
+    ok = std::fseek( file_, 0, SEEK_SET ) == 0 && std::fwrite( &header, sizeof(header), 1, file_ ) == 1;
+  } catch( const std::runtime_error& ){
+    ok = false;
+  }
+  ok = std::fclose( file_ ) == 0 && ok;
+  file_ = nullptr;
+  if( !ok )
+    throw std::runtime_error( "TrajectoryWriter: finishing the file failed" );
+}
+
+auto TrajectoryWriter::Append( const void* data, size_t size ) -> void {
+  auto bytes = static_cast<const char*>( data );
+  offset_ += size;
+  while( size > 0 ){
+    auto chunk = std::min( size, buffer_size_ - buffer_.size() );
+    buffer_.insert( buffer_.end(), bytes, bytes + chunk );
+    bytes += chunk;
+    size -= chunk;
+    if( buffer_.size() == buffer_size_ )
+      Flush();
+  }
+}
+
+auto TrajectoryWriter::AppendPoints( const BodyStorage& storage ) -> void {
+  constexpr size_t BLOCK = 256;
+  Point2D points[BLOCK];
+  for( size_t begin=0; begin<storage.Size(); begin+=BLOCK ){
+    auto n = std::min( BLOCK, storage.Size() - begin );
+    for( size_t i=0; i<n; ++i )
+      points[i] = Point2D{ storage.x[begin+i], storage.y[begin+i] };
+    Append( points, n * sizeof(Point2D) );
+  }
+}
+
+auto TrajectoryWriter::Flush() -> void {
+  if( !buffer_.empty() && std::fwrite( buffer_.data(), 1, buffer_.size(), file_ ) != buffer_.size() )
+    throw std::runtime_error( "TrajectoryWriter: write failed" );
+  buffer_.clear();
+}
+
+TrajectoryReader::TrajectoryReader( const std::string& path ){
+  auto fd = ::open( path.c_str(), O_RDONLY );
+  if( fd < 0 )
+    throw std::runtime_error( "TrajectoryReader: cannot open " + path );
+  struct stat st{};
+  ::fstat( fd, &st );
+  size_ = static_cast<size_t>( st.st_size );
+  if( size_ < sizeof(TrajectoryHeader) ){
+    ::close( fd );
+    throw std::runtime_error( "TrajectoryReader: " + path + " is too short" );
+  }
+  auto mapping = ::mmap( nullptr, size_, PROT_READ, MAP_PRIVATE, fd, 0 );
+  ::close( fd );
+  if( mapping == MAP_FAILED )
+    throw std::runtime_error( "TrajectoryReader: cannot map " + path );
+  data_ = static_cast<const char*>( mapping );
+  std::memcpy( &header_, data_, sizeof(header_) );
+  if( std::memcmp( header_.magic, TrajectoryHeader::MAGIC, sizeof(header_.magic) ) != 0 
+      || header_.version != TrajectoryHeader::VERSION || header_.point_size != sizeof(Point2D)
+      || header_.index_offset < sizeof(TrajectoryHeader) || header_.index_offset > size_
+      || header_.n_frames > ( size_ - header_.index_offset ) / sizeof(uint64_t) ){
+    ::munmap( const_cast<char*>(data_), size_ );
+    throw std::runtime_error( "TrajectoryReader: " + path + " is not a finished trajectory file" );
+  }
+  ::madvise( const_cast<char*>(data_), size_, MADV_SEQUENTIAL );
+  index_ = reinterpret_cast<const uint64_t*>( data_ + header_.index_offset );
+}
+
+TrajectoryReader::~TrajectoryReader(){ 
+  if( data_ )
+    ::munmap( const_cast<char*>(data_), size_ ); 
+}
+
+auto TrajectoryReader::GetFrame( size_t i ) const -> TrajectoryFrame {
+  if( i >= header_.n_frames )
+    throw std::out_of_range( "TrajectoryReader: frame out of range" );
+  auto offset = index_[i];
+  if( offset > size_ || size_ - offset < sizeof(TrajectoryFrameHeader) )
+    throw std::runtime_error( "TrajectoryReader: frame " + std::to_string(i) + " lies outside the file" );
+  auto frame = reinterpret_cast<const TrajectoryFrameHeader*>( data_ + offset );
+  auto room = ( size_ - offset - sizeof(TrajectoryFrameHeader) ) / sizeof(Point2D);
+  if( frame->n_bodies > room || frame->n_particles > room - frame->n_bodies )
+    throw std::runtime_error( "TrajectoryReader: frame " + std::to_string(i) + " runs past the end of the file" );
+  auto points = reinterpret_cast<const Point2D*>( frame + 1 );
+  return { frame->time, { points, frame->n_bodies }, { points + frame->n_bodies, frame->n_particles } };
+}
@@ -0,0 +1,84 @@
+#ifndef TRAJECTORY_H
+#define TRAJECTORY_H
+
+#include <cstdint>
+#include <cstdio>
+#include <span>
+#include <string>
+#include <vector>
+
+#include "body_storage.h"
+#include "coordinates.h"
+
+// Binary trajectory file, native endianness:
+//   TrajectoryHeader | frame 0 | frame 1 | ... | uint64_t offset[n_frames]
+// Each frame is a TrajectoryFrameHeader followed by the positions of all bodies and then all
+// particles as Point2D, in World storage order. All blocks are multiples of 8 bytes, so a
+// memory-mapped file can be read in place.
+struct TrajectoryHeader{
+  static constexpr char MAGIC[8] = { 'G', 'T', 'R', 'A', 'J', '\0', '\0', '\0' };
+  static constexpr uint32_t VERSION = 1;
+  char magic[8]{};
+  uint32_t version{VERSION};
+  uint32_t point_size{ sizeof(Point2D) };
+  uint64_t n_frames{};
+  uint64_t index_offset{};
+  uint64_t reserved[4]{};
+};
+
+struct TrajectoryFrameHeader{
+  double time{};
+  uint64_t n_bodies{};
+  uint64_t n_particles{};
+  uint64_t reserved{};
+};
+
+struct TrajectoryFrame{
+  double time{};
+  std::span<const Point2D> bodies{};
+  std::span<const Point2D> particles{};
+};
+
+class TrajectoryWriter{
+public:
+  explicit TrajectoryWriter( const std::string& path, size_t buffer_size = size_t{1} << 22 );
+  ~TrajectoryWriter();
+  TrajectoryWriter( const TrajectoryWriter& ) = delete;
+  TrajectoryWriter& operator=( const TrajectoryWriter& ) = delete;
+
+  auto Write( double time, const BodyStorage& bodies, const BodyStorage& particles ) -> void;
+  // Flushes the buffer, appends the frame index and finalizes the header. Called by the destructor.
+  auto Close() -> void;
+  auto GetFrameCount() const noexcept -> size_t { return offsets_.size(); }
+
+private:
+  auto Append( const void* data, size_t size ) -> void;
+  auto AppendPoints( const BodyStorage& storage ) -> void;
+  auto Flush() -> void;
+
+  std::FILE* file_{nullptr};
+  std::vector<char> buffer_{};
+  size_t buffer_size_{};
+  uint64_t offset_{};
+  std::vector<uint64_t> offsets_{};
+};
+
+class TrajectoryReader{
+public:
+  explicit TrajectoryReader( const std::string& path );
+  ~TrajectoryReader();
+  TrajectoryReader( const TrajectoryReader& ) = delete;
+  TrajectoryReader& operator=( const TrajectoryReader& ) = delete;
+
+  auto GetFrameCount() const noexcept -> size_t { return header_.n_frames; }
+  // O(1) through the frame index; the spans point straight into the mapping.
+  auto GetFrame( size_t i ) const -> TrajectoryFrame;
+
+private:
+  const char* data_{nullptr};
+  size_t size_{};
+  TrajectoryHeader header_{};
+  const uint64_t* index_{nullptr};
+};
+
+#endif // TRAJECTORY_H
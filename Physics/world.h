@@ -2,24 +2,423 @@
 #define WORLD_H
 
 #include "body.h"
+#include "body_storage.h"
+#include "checkpoint.h"
+#include "collision.h"
 #include "coordinates.h"
+#include "diagnostics.h"
 #include "gravitation.h"
+#include "integrator.h"
+#include "profiler.h"
+#include "quad_tree.h"
+#include "scenario.h"
+#include "snapshot.h"
+#include "thread_pool.h"
+#include "trajectory.h"
+
 #include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <functional>
 #include <memory>
+#include <span>
+#include <stdexcept>
+#include <string>
+
+enum class Solver{
+  PAIRWISE,
+  BARNES_HUT
+};
+
+// MIXED runs the pairwise force loop in float on offsets from the bodies' bounding-box center.
+enum class Precision{
+  DOUBLE,
+  MIXED
+};
 
+template<typename Integrator = Leapfrog>
 class World{
 public:
+  using CollisionCallback = std::function<void(BodyHandle, BodyHandle)>;
   World() = default;
+  World( Solver solver, double opening_angle = 0.5 ) : solver_(solver), opening_angle_(opening_angle) {}
+
+  auto AddBody( const Body& body ) -> BodyHandle { 
+    accelerations_valid_ = false;
+    auto index = bodies_.Add( body );
+    return { &bodies_, bodies_.id[index] }; 
+  }
+  auto RemoveBody( BodyHandle body ) -> void {
+    if( !body.IsValid() )
+      return;
+    collisions_.Remove( body.GetId() );
+    bodies_.Remove( body.GetIndex() );
+    accelerations_valid_ = false;
+  }
+  // Merges two bodies into the heavier one, conserving mass, momentum and volume.
+  auto MergeBodies( BodyHandle first, BodyHandle second ) -> BodyHandle {
+    if( first.GetMass() < second.GetMass() )
+      std::swap( first, second );
+    auto m1 = first.GetMass();
+    auto m2 = second.GetMass();
+    auto m = m1 + m2;
+    auto w1 = m > 0 ? m1 / m : 0.5;
+    auto w2 = 1.0 - w1;
+    first.SetPosition( first.GetPosition() * w1 + second.GetPosition() * w2 );
+    first.SetVelocity( first.GetVelocity() * w1 + second.GetVelocity() * w2 );
+    first.SetRadius( std::cbrt( std::pow( first.GetRadius(), 3 ) + std::pow( second.GetRadius(), 3 ) ) );
+    first.SetMass( m );
+    RemoveBody( second );
+    return first;
+  }
+  // Test particles feel the massive bodies but exert no force, so they cost O(N_bodies) each.
+  auto AddParticle( const Body& particle ) -> BodyHandle {
+    accelerations_valid_ = false;
+    auto index = particles_.Add( particle );
+    return { &particles_, particles_.id[index] };
+  }
+  // Appends a whole body list at once, e.g. Scenario::UniformDisk( n ) or Scenario::Load( path ).
+  // The generator writes straight into the columns and uses the World's thread pool.
+  auto Populate( const Scenario::Generator& generator ) -> World& {
+    accelerations_valid_ = false;
+    generator( bodies_, pool_.get() );
+    return *this;
+  }
+  auto PopulateParticles( const Scenario::Generator& generator ) -> World& {
+    accelerations_valid_ = false;
+    generator( particles_, pool_.get() );
+    return *this;
+  }
+  auto Reserve( size_t n ) -> World& { bodies_.Reserve(n); return *this; }
+  auto ReserveParticles( size_t n ) -> World& { particles_.Reserve(n); return *this; }
+  auto SetSolver( Solver solver ) noexcept -> World& { solver_ = solver; accelerations_valid_ = false; return *this; }
+  auto SetOpeningAngle( double theta ) noexcept -> World& { opening_angle_ = theta; accelerations_valid_ = false; return *this; }
+  auto SetSoftening( double length ) noexcept -> World& { softening_ = length; accelerations_valid_ = false; return *this; }
+  auto SetPrecision( Precision precision ) noexcept -> World& { precision_ = precision; accelerations_valid_ = false; return *this; }
+
+  // Overlapping bodies (by radius) are merged after every step, or passed to the callback if one is set.
+  auto SetCollisions( bool enabled ) -> World& { collisions_enabled_ = enabled; collisions_.Clear(); return *this; }
+  auto SetCollisionCallback( CollisionCallback callback ) -> World& { collision_callback_ = std::move(callback); return *this; }
+  // Feeds every `every`-th step into the writer; the writer must outlive the registration.
+  auto RegisterRecorder( TrajectoryWriter& writer, size_t every = 1 ) -> World& {
+    recorder_ = GenerateRecorder( writer, std::max( every, size_t{1} ) );
+    recorder_();
+    return *this;
+  }
+  auto UnregisterRecorder() -> World& { recorder_ = nullptr; return *this; }
+  // Publishes every `every`-th step to a render thread. Propagate() must then run on a single thread,
+  // the buffer's writer; the buffer must outlive the registration.
+  auto RegisterSnapshotBuffer( SnapshotBuffer& buffer, size_t every = 1 ) -> World& {
+    publisher_ = GeneratePublisher( buffer, std::max( every, size_t{1} ) );
+    publisher_();
+    return *this;
+  }
+  auto UnregisterSnapshotBuffer() -> World& { publisher_ = nullptr; return *this; }
+  // Samples the conserved quantities every `every`-th step, 0 switches sampling off. The potential
+  // energy must belong to the end-of-step positions. Integrators that declare FORCE_PASS_LAST
+  // (VelocityVerlet) yield it as a by-product of their final force pass, so a sample adds O(N) work.
+  // All others end with a drift and pay one potential-only pass with the active solver per sample.
+  auto SetDiagnosticsInterval( size_t every ) noexcept -> World& { diagnostics_every_ = every; return *this; }
+  auto SetThreadCount( size_t n_threads ) -> World& {
+    pool_ = n_threads > 1 ? std::make_shared<ThreadPool>( n_threads ) : nullptr;
+    return *this;
+  }
+  auto SetThreadPool( std::shared_ptr<ThreadPool> pool ) noexcept -> World& { pool_ = std::move(pool); return *this; }
 
-  auto AddBody( Body* body ) noexcept -> World& { bodies_.emplace_back( body ); return *this; }
+  auto GetThreadCount() const noexcept -> size_t { return pool_ ? pool_->GetThreadCount() : 1; }
+  auto GetSolver() const noexcept -> Solver { return solver_; }
+  auto GetOpeningAngle() const noexcept -> double { return opening_angle_; }
+  auto GetSoftening() const noexcept -> double { return softening_; }
+  auto GetPrecision() const noexcept -> Precision { return precision_; }
+  auto GetDiagnosticsInterval() const noexcept -> size_t { return diagnostics_every_; }
+  // The most recent sample; time and steps tell which step it belongs to.
+  auto Diagnostics() const noexcept -> const WorldDiagnostics& { return diagnostics_; }
+  // Samples the current state right away, with a separate potential pass.
+  auto SampleDiagnostics() -> const WorldDiagnostics& {
+    ComputePotential();
+    UpdateDiagnostics();
+    return diagnostics_;
+  }
+  auto GetTime() const noexcept -> double { return time_; }
+  auto GetSteps() const noexcept -> size_t { return steps_; }
+  auto GetIntegrator() noexcept -> Integrator& { return integrator_; }
+  auto GetBody( size_t index ) noexcept -> BodyHandle { return { &bodies_, bodies_.id[index] }; }
+  auto GetBodies() const noexcept -> const BodyStorage& { return bodies_; }
+  auto GetBodies() noexcept -> BodyStorage& { return bodies_; }
+  auto GetParticle( size_t index ) noexcept -> BodyHandle { return { &particles_, particles_.id[index] }; }
+  auto GetParticles() const noexcept -> const BodyStorage& { return particles_; }
+  auto GetParticles() noexcept -> BodyStorage& { return particles_; }
+  auto GetTree() const noexcept -> const QuadTree& { return tree_; }
+  // False after anything that changes the forces, including edits through a BodyHandle.
+  auto AccelerationsValid() const noexcept -> bool { return accelerations_valid_ && !bodies_.Edited() && !particles_.Edited(); }
 
   auto Propagate( const double dt ){
-    std::for_each( bodies_.begin(), bodies_.end(), [this, dt](auto& p){ Gravitation::MoveBody(dt, p.get(), bodies_); } );
+    PROFILE_SCOPE( "World::Propagate" );
+    auto sample = diagnostics_every_ > 0 && ( steps_ + 1 ) % diagnostics_every_ == 0;
+    potential_requested_ = sample && FUSED_POTENTIAL;
+    potential_ready_ = false;
+    integrator_.Step( *this, dt );
+    time_ += dt;
+    ++steps_;
+    potential_requested_ = false;
+    if( sample ){
+      if( !potential_ready_ )
+        ComputePotential();
+      UpdateDiagnostics();
+    }
+    if( collisions_enabled_ )
+      ResolveCollisions();
+    if( recorder_ )
+      recorder_();
+    if( publisher_ )
+      publisher_();
+  }
+
+  auto SaveCheckpoint( const std::string& path ) const -> void {
+    auto file = Checkpoint::Open( path, "wb" );
+    auto header = MakeCheckpointHeader();
+    Checkpoint::Write( file.get(), &header, sizeof(header) );
+    if constexpr( HAS_INTEGRATOR_STATE ){
+      auto start = std::ftell( file.get() );
+      integrator_.SaveState( file.get() );
+      header.integrator_state_size = static_cast<uint64_t>( std::ftell( file.get() ) - start );
+    }
+    Checkpoint::WriteStorage( file.get(), bodies_ );
+    Checkpoint::WriteStorage( file.get(), particles_ );
+    std::fseek( file.get(), 0, SEEK_SET );
+    Checkpoint::Write( file.get(), &header, sizeof(header) );
+  }
+  // Replaces all bodies, particles and the simulation clock. Handles issued before stay
+  // valid for bodies with the same id. Throws std::runtime_error on a mismatching or corrupt
+  // file, in which case the World is left unchanged: everything is read into temporaries first.
+  auto LoadCheckpoint( const std::string& path ) -> void {
+    auto file = Checkpoint::Open( path, "rb" );
+    auto header = CheckpointHeader{};
+    Checkpoint::Read( file.get(), &header, sizeof(header) );
+    auto expected = MakeCheckpointHeader();
+    if( std::memcmp( header.magic, CheckpointHeader::MAGIC, sizeof(header.magic) ) != 0 || header.version != CheckpointHeader::VERSION )
+      throw std::runtime_error( "World: " + path + " is not a version " + std::to_string(CheckpointHeader::VERSION) + " checkpoint" );
+    if( header.solver > static_cast<uint32_t>( Solver::BARNES_HUT ) || header.precision > static_cast<uint32_t>( Precision::MIXED ) )
+      throw std::runtime_error( "World: " + path + " has an unknown solver or precision" );
+    if( header.integrator_state_size > Checkpoint::Remaining( file.get() ) )
+      throw std::runtime_error( "World: " + path + " is truncated" );
+    auto same_integrator = std::strncmp( header.integrator, expected.integrator, sizeof(header.integrator) ) == 0;
+    auto integrator = integrator_;
+    auto state_loaded = false;
+    if constexpr( HAS_INTEGRATOR_STATE ){
+      if( same_integrator ){
+        auto start = std::ftell( file.get() );
+        integrator.LoadState( file.get() );
+        if( static_cast<uint64_t>( std::ftell( file.get() ) - start ) != header.integrator_state_size )
+          throw std::runtime_error( "World: " + path + " has a mismatching integrator state" );
+        state_loaded = true;
+      }
+    }
+    if( !state_loaded && std::fseek( file.get(), static_cast<long>( header.integrator_state_size ), SEEK_CUR ) != 0 )
+      throw std::runtime_error( "World: " + path + " is truncated" );
+    auto bodies = BodyStorage{};
+    auto particles = BodyStorage{ true };
+    Checkpoint::ReadStorage( file.get(), bodies, header.n_bodies, header.next_body_id );
+    Checkpoint::ReadStorage( file.get(), particles, header.n_particles, header.next_particle_id );
+
+    integrator_ = std::move( integrator );
+    std::swap( bodies_, bodies );
+    std::swap( particles_, particles );
+    solver_ = static_cast<Solver>( header.solver );
+    precision_ = static_cast<Precision>( header.precision );
+    opening_angle_ = header.opening_angle;
+    softening_ = header.softening;
+    time_ = header.time;
+    steps_ = header.steps;
+    collisions_enabled_ = header.collisions != 0;
+    collisions_.Clear();
+    // Stored accelerations are only reusable by the integrator that produced them.
+    accelerations_valid_ = same_integrator && header.accelerations_valid != 0;
+  }
+
+  auto ComputeAccelerations() -> void {
+    if( solver_ == Solver::BARNES_HUT )
+      tree_.Build( bodies_ );
+    if( solver_ == Solver::PAIRWISE && precision_ == Precision::MIXED )
+      PrepareMixedSources();
+    auto n_bodies = bodies_.Size();
+    if( potential_requested_ )
+      potential_.resize( n_bodies );
+    auto* potential = potential_requested_ ? potential_.data() : nullptr;
+    ParallelFor( n_bodies + particles_.Size(), [this, n_bodies, potential]( size_t begin, size_t end ){ 
+      if( begin < n_bodies )
+        AccelerateRange( bodies_, begin, std::min( end, n_bodies ), potential );
+      if( end > n_bodies )
+        AccelerateRange( particles_, std::max( begin, n_bodies ) - n_bodies, end - n_bodies );
+    } );
+    SetAccelerationsValid();
+    potential_ready_ = potential_requested_;
+  }
+  // Pairwise accelerations and jerks for a subset of targets (bodies or particles), as needed by BlockTimestep.
+  auto ComputeAccelerationJerk( BodyStorage& targets, std::span<const size_t> active, double* jx, double* jy ) -> void {
+    ParallelFor( active.size(), [this, &targets, active, jx, jy]( size_t begin, size_t end ){ 
+      Gravitation::AccelerateJerk( bodies_, targets, active.subspan( begin, end - begin ), jx, jy, softening_ * softening_ ); 
+    } );
+  }
+  auto SetAccelerationsValid() noexcept -> void {
+    accelerations_valid_ = true;
+    bodies_.ClearEdited();
+    particles_.ClearEdited();
+  }
+  auto Kick( const double dt ) noexcept -> void {
+    Kick( bodies_, dt );
+    Kick( particles_, dt );
+  }
+  auto Drift( const double dt ) noexcept -> void {
+    potential_ready_ = false;
+    Drift( bodies_, dt );
+    Drift( particles_, dt );
+    accelerations_valid_ = false;
   }
 
 private:
-  Body rocket_{};
-  std::vector<std::unique_ptr<Body>> bodies_;
+  static constexpr bool HAS_INTEGRATOR_STATE = requires( Integrator& i, std::FILE* f ){ i.SaveState(f); i.LoadState(f); };
+  static constexpr bool FUSED_POTENTIAL = requires{ requires Integrator::FORCE_PASS_LAST; };
+  auto MakeCheckpointHeader() const noexcept -> CheckpointHeader {
+    auto header = CheckpointHeader{};
+    std::memcpy( header.magic, CheckpointHeader::MAGIC, sizeof(header.magic) );
+    std::strncpy( header.integrator, Integrator::NAME, sizeof(header.integrator) - 1 );
+    header.solver = static_cast<uint32_t>( solver_ );
+    header.precision = static_cast<uint32_t>( precision_ );
+    header.n_bodies = bodies_.Size();
+    header.n_particles = particles_.Size();
+    header.next_body_id = bodies_.NextId();
+    header.next_particle_id = particles_.NextId();
+    header.steps = steps_;
+    header.time = time_;
+    header.opening_angle = opening_angle_;
+    header.softening = softening_;
+    header.accelerations_valid = AccelerationsValid();
+    header.collisions = collisions_enabled_;
+    return header;
+  }
+  auto GenerateRecorder( TrajectoryWriter& writer, size_t every ) -> std::function<void(void)> {
+    return [&writer, every, this](){ 
+      if( steps_ % every == 0 )
+        writer.Write( time_, bodies_, particles_ ); 
+    };
+  }
+  auto GeneratePublisher( SnapshotBuffer& buffer, size_t every ) -> std::function<void(void)> {
+    return [&buffer, every, this](){
+      if( steps_ % every != 0 )
+        return;
+      buffer.GetWriteBuffer().Assign( time_, steps_, bodies_, particles_ );
+      buffer.Publish();
+    };
+  }
+  auto ResolveCollisions() -> void {
+    for( auto [first, second] : collisions_.FindCollisions( bodies_ ) ){
+      auto a = BodyHandle{ &bodies_, first };
+      auto b = BodyHandle{ &bodies_, second };
+      if( !a.IsValid() || !b.IsValid() )
+        continue;
+      if( collision_callback_ )
+        collision_callback_( a, b );
+      else
+        MergeBodies( a, b );
+    }
+  }
+  template<typename F>
+  auto ParallelFor( size_t n, const F& func ) -> void {
+    if( !pool_ ){
+      func( 0, n );
+      return;
+    }
+    // Several chunks per thread so that stealing can rebalance close-encounter hot spots.
+    auto grain = std::max( n / ( pool_->GetThreadCount() * 8 ), size_t{16} );
+    pool_->ParallelFor( 0, n, grain, func );
+  }
+  auto AccelerateRange( BodyStorage& targets, size_t begin, size_t end, double* potential = nullptr ) noexcept -> void {
+    switch( solver_ ){
+      case Solver::PAIRWISE:
+        if( precision_ == Precision::MIXED )
+          Gravitation::Accelerate( mixed_sources_, mixed_masses_, targets, begin, end, softening_ * softening_, potential );
+        else
+          Gravitation::Accelerate( bodies_, targets, begin, end, softening_ * softening_, potential );
+        break;
+      case Solver::BARNES_HUT:
+        for( auto i=begin; i<end; ++i ){
+          auto a = tree_.Acceleration( { targets.x[i], targets.y[i] }, opening_angle_, softening_ * softening_,
+                                       potential ? potential + i : nullptr );
+          targets.ax[i] = a.x;
+          targets.ay[i] = a.y;
+        }
+        break;
+    }
+  }
+  auto ComputePotential() -> void {
+    potential_.resize( bodies_.Size() );
+    if( solver_ == Solver::BARNES_HUT ){
+      tree_.Build( bodies_ );
+      ParallelFor( bodies_.Size(), [this]( size_t begin, size_t end ){
+        for( auto i=begin; i<end; ++i )
+          tree_.Acceleration( { bodies_.x[i], bodies_.y[i] }, opening_angle_, softening_ * softening_, potential_.data() + i );
+      } );
+      return;
+    }
+    ParallelFor( bodies_.Size(), [this]( size_t begin, size_t end ){
+      Gravitation::Potential( bodies_, bodies_, begin, end, potential_.data(), softening_ * softening_ );
+    } );
+  }
+  auto UpdateDiagnostics() -> void {
+    diagnostics_ = WorldDiagnostics::Measure( bodies_, potential_ );
+    diagnostics_.time = time_;
+    diagnostics_.steps = steps_;
+  }
+  auto PrepareMixedSources() -> void {
+    auto origin = Point2D{};
+    if( !bodies_.Empty() ){
+      auto [lo_x, hi_x] = std::minmax_element( bodies_.x.begin(), bodies_.x.end() );
+      auto [lo_y, hi_y] = std::minmax_element( bodies_.y.begin(), bodies_.y.end() );
+      origin = Point2D{ ( *lo_x + *hi_x ) / 2, ( *lo_y + *hi_y ) / 2 };
+    }
+    mixed_sources_.Assign( bodies_.x, bodies_.y, origin );
+    mixed_masses_.assign( bodies_.mass.begin(), bodies_.mass.end() );
+  }
+  static auto Kick( BodyStorage& s, const double dt ) noexcept -> void {
+    auto n = s.Size();
+    for( size_t i=0; i<n; ++i ){
+      s.vx[i] += s.ax[i] * dt;
+      s.vy[i] += s.ay[i] * dt;
+    }
+  }
+  static auto Drift( BodyStorage& s, const double dt ) noexcept -> void {
+    auto n = s.Size();
+    for( size_t i=0; i<n; ++i ){
+      s.x[i] += s.vx[i] * dt;
+      s.y[i] += s.vy[i] * dt;
+    }
+  }
+
+  BodyStorage bodies_{};
+  BodyStorage particles_{ true };
+  Solver solver_{Solver::PAIRWISE};
+  double opening_angle_{0.5};
+  double softening_{0.0};
+  Precision precision_{Precision::DOUBLE};
+  OffsetPoints<float> mixed_sources_{};
+  std::vector<float> mixed_masses_{};
+  QuadTree tree_{};
+  Integrator integrator_{};
+  double time_{};
+  size_t steps_{};
+  bool accelerations_valid_{false};
+  std::shared_ptr<ThreadPool> pool_{};
+  bool collisions_enabled_{false};
+  CollisionDetector collisions_{};
+  CollisionCallback collision_callback_{};
+  std::function<void(void)> recorder_{};
+  std::function<void(void)> publisher_{};
+  size_t diagnostics_every_{0};
+  WorldDiagnostics diagnostics_{};
+  std::vector<double> potential_{};
+  bool potential_requested_{false};
+  bool potential_ready_{false};
 };
 
-#endif // WORLD_H
\ No newline at end of file
+#endif // WORLD_H
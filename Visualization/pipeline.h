@@ -9,7 +9,7 @@ namespace Visualization {
 template<typename Func>
 class Pipeline{
 public:
-  Pipeline<Func>(Func func) : visualizer_( std::move(func) ) { visualizer_.RegisterWindow(window_); }
+  Pipeline(Func func) : visualizer_( std::move(func) ) { visualizer_.RegisterWindow(window_); }
   auto GetVisualizer() -> Visualizer<Func>& { return visualizer_; }
   auto GetWindow() -> Window& {return window_;}
   auto Draw() -> void {
@@ -6,6 +6,8 @@
 #include "pipeline.h"
 #include "polygon.h"
 #include "shape.h"
+#include "simulation_clock.h"
+#include "snapshot.h"
 #include "window.h"
 #include "world.h"
 #include <chrono>
@@ -14,19 +16,21 @@
 auto main() -> int {
   using namespace Visualization;
   auto physics_engine = World();
-  auto earth = new Body{TheEarth};
-  auto moon = new Body{TheMoon};
-  physics_engine.AddBody(earth);
-  physics_engine.AddBody(moon);
-  earth->SetPosition( {0.0, 0.0} );
-  moon->SetPosition( {380'000., 0} );
+  auto earth = physics_engine.AddBody(TheEarth);
+  auto moon = physics_engine.AddBody(TheMoon);
+  earth.SetPosition( {0.0, 0.0} );
+  moon.SetPosition( {380'000., 0} );
   auto moon_speed = sqrt(Gravitation::G / 380'000 );
-  moon->SetVelocity( {0., moon_speed} );
+  moon.SetVelocity( {0., moon_speed} );
 
   auto earth_shape = Shape().AddPolygon( Polygon{{0.0, 0.0}, size_t(100), 6.4} );
   auto moon_shape = Shape().AddPolygon( Polygon{{0.0, 0.0}, size_t(100), 1.7} );
 
+  auto snapshots = SnapshotBuffer{};
+  physics_engine.RegisterSnapshotBuffer( snapshots );
+
   auto pipeline = Pipeline{ []( const Point2D& pos ){ return pos/3800; } };
+  pipeline.GetVisualizer().RegisterSnapshotBuffer( snapshots );
   pipeline.GetVisualizer().RegisterPlanet(earth, earth_shape );
   pipeline.GetVisualizer().RegisterPlanet(moon, moon_shape );
 
@@ -34,16 +38,18 @@ auto main() -> int {
   cam.Scale( 1 );
   cam.RegisterWindow( pipeline.GetWindow() );
   cam.NotifyWindow();
+  pipeline.GetVisualizer().RegisterCamera( cam );
 
-  auto mouse = Mouse( *pipeline.GetWindow() );
+  auto mouse = Mouse( pipeline.GetWindow() );
   auto cam_control = CameraControl();
   cam_control.RegisterCamera(cam);
   cam_control.RegisterMouse(mouse);
 
   auto thread_phys = std::thread{ [&physics_engine](){
+    auto clock = SimulationClock{ 1.0, 500.0 };
     while (true) {
-      physics_engine.Propagate(10);
-      std::this_thread::sleep_for(std::chrono::milliseconds{20} );
+      clock.Tick( physics_engine );
+      std::this_thread::sleep_until( clock.GetNextStepTime() );
     }
   } };
   auto thread_vis = std::thread{ [&pipeline, &cam_control, &mouse](){
@@ -51,7 +57,6 @@ auto main() -> int {
       pipeline.Draw();
       mouse.Listen();
       cam_control.Update();
-      std::this_thread::sleep_for(std::chrono::milliseconds{20} );
     }
   } };
   
@@ -1,13 +1,19 @@
 #ifndef VISUALIZER_H
 #define VISUALIZER_H
 
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
 #include <map>
+#include <memory>
+#include <vector>
 
 #include "camera.h"
-#include "render_engine.h"
 #include "scene.h"
+#include "profiler.h"
 #include "window.h"
-#include "body.h"
+#include "body_storage.h"
+#include "snapshot.h"
 
 namespace Visualization{
 
@@ -16,21 +22,118 @@ class Visualizer{
 public:
   Visualizer(Func function) : coordinate_tranformation_(std::move(function)) {};
 
-  auto RegisterPlanet( Body* body, Shape shape ) -> Visualizer<Func>& { planets_.emplace( std::make_pair(body, shape) ); return *this; }
+  // Bodies and test particles have separate ids, so each is tracked in its own population.
+  auto RegisterPlanet( BodyHandle body, Shape shape ) -> Visualizer<Func>& {
+    auto& population = body.IsParticle() ? particles_ : bodies_;
+    population.planets.emplace( body.GetId(), Planet{ &scene_.AddShape( std::make_unique<Shape>( std::move(shape) ) ) } );
+    return *this;
+  }
+  // Positions are read from the snapshots the World publishes, never from the World itself.
+  auto RegisterSnapshotBuffer( SnapshotBuffer& buffer ) -> Visualizer<Func>& { snapshots_ = &buffer; return *this; }
+  // Draws the bodies between the previous and the newest snapshot. The blend factor follows from how
+  // long ago the newest snapshot arrived relative to the usual interval between snapshots, so the
+  // motion stays smooth whatever the ratio of frame rate to physics rate is. Nothing is drawn
+  // before the World published its first snapshot.
   auto Visualize(){
-    for( auto& pair : planets_ ){
-      auto coord = coordinate_tranformation_( pair.first->GetPosition() );
-      pair.second.Translate( coord );
-      render_engine_.AddToQueue( pair.second );
-    }
-    render_engine_.Render();
-    render_engine_.Notify();
+    PROFILE_SCOPE( "Visualizer::Visualize" );
+    if( !snapshots_ || !Acquire() )
+      return;
+    auto since = std::chrono::duration<double>( Clock::now() - arrival_ ).count();
+    Draw( interval_ > 0 ? std::min( since / interval_, 1.0 ) : 1.0 );
+  }
+  // Same with an explicit blend factor, e.g. SimulationClock::GetAlpha() when one thread steps and draws.
+  auto Visualize( double alpha ){
+    PROFILE_SCOPE( "Visualizer::Visualize" );
+    if( !snapshots_ || !Acquire() )
+      return;
+    Draw( std::clamp( alpha, 0.0, 1.0 ) );
   }
-  auto RegisterWindow( Window& w ) -> Visualizer<Func>& { render_engine_.RegisterWindow(w); return *this; }
+  auto RegisterWindow( Window& w ) -> Visualizer<Func>& { scene_.RegisterWindow(w); return *this; }
+  auto RegisterTarget( HeadlessTarget& t ) -> Visualizer<Func>& { scene_.RegisterTarget(t); return *this; }
+  // Planets outside the camera's view are not drawn.
+  auto RegisterCamera( Camera& c ) -> Visualizer<Func>& { scene_.RegisterCamera(c); return *this; }
 
 private:
-  RenderEngine render_engine_{};
-  std::map<Body*, Shape> planets_{};
+  using Clock = std::chrono::steady_clock;
+  struct Planet{
+    Shape* shape{nullptr};
+    uint64_t frame{0};
+  };
+  struct Population{
+    std::map<size_t, Planet> planets{};
+    // Index of each id in previous_, NPOS if it was not there.
+    std::vector<size_t> previous_index{};
+  };
+  // True once a snapshot is available, i.e. the World published at least once.
+  auto Acquire() -> bool {
+    if( !snapshots_->HasUpdate() )
+      return current_ != nullptr;
+    auto now = Clock::now();
+    if( current_ ){
+      previous_ = *current_;
+      IndexById( previous_.id, bodies_.previous_index );
+      IndexById( previous_.particle_id, particles_.previous_index );
+      auto interval = std::chrono::duration<double>( now - arrival_ ).count();
+      interval_ = interval_ > 0 ? 0.8 * interval_ + 0.2 * interval : interval;
+    }
+    current_ = &snapshots_->Read();
+    arrival_ = now;
+    return true;
+  }
+  auto Draw( double alpha ) -> void {
+    const auto& snapshot = *current_;
+    ++frame_;
+    Place( bodies_, snapshot.id, snapshot.x, snapshot.y, previous_.x, previous_.y, alpha );
+    Place( particles_, snapshot.particle_id, snapshot.particle_x, snapshot.particle_y, previous_.particle_x,
+           previous_.particle_y, alpha );
+    scene_.Update();
+  }
+  // Moves every registered planet to its position, blended with the previous snapshot's position of
+  // the same id. Indices are not comparable across snapshots, because removing a body reorders them.
+  auto Place( Population& population, const std::vector<size_t>& ids, const std::vector<double>& x,
+              const std::vector<double>& y, const std::vector<double>& previous_x, const std::vector<double>& previous_y,
+              double alpha ) -> void {
+    auto drawn = size_t{0};
+    for( size_t i=0; i<ids.size(); ++i ){
+      auto id = ids[i];
+      auto planet = population.planets.find( id );
+      if( planet == population.planets.end() )
+        continue;
+      auto position = Point2D{ x[i], y[i] };
+      if( id < population.previous_index.size() && population.previous_index[id] != BodyStorage::NPOS ){
+        auto j = population.previous_index[id];
+        auto before = Point2D{ previous_x[j], previous_y[j] };
+        position = before + ( position - before ) * alpha;
+      }
+      planet->second.shape->Translate( coordinate_tranformation_( position ) );
+      planet->second.frame = frame_;
+      ++drawn;
+    }
+    // Bodies merged or removed by the World never come back, so their shapes leave the scene.
+    if( drawn < population.planets.size() )
+      std::erase_if( population.planets, [this]( auto& planet ){
+        if( planet.second.frame == frame_ )
+          return false;
+        scene_.RemoveShape( planet.second.shape );
+        return true;
+      } );
+  }
+  static auto IndexById( const std::vector<size_t>& ids, std::vector<size_t>& index ) -> void {
+    auto n = ids.empty() ? size_t{0} : *std::max_element( ids.begin(), ids.end() ) + 1;
+    index.assign( n, BodyStorage::NPOS );
+    for( size_t i=0; i<ids.size(); ++i )
+      index[ ids[i] ] = i;
+  }
+
+  Scene scene_{};
+  Population bodies_{};
+  Population particles_{};
+  uint64_t frame_{0};
+  SnapshotBuffer* snapshots_{nullptr};
+  const WorldSnapshot* current_{nullptr};
+  WorldSnapshot previous_{};
+  Clock::time_point arrival_{Clock::now()};
+  double interval_{0.0};
   Func coordinate_tranformation_{};
 };
 